@@ -1,25 +1,16 @@
 #include <algorithm>
+#include <bit>
 #include <cassert>
-#include <memory>
 #include <print>
+#include <set>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <utility>
 
 #include "OMs.h"
-
-// number of permutations
-static size_t w;
-
-// the list of permutations
-static std::unique_ptr<std::unique_ptr<char[]>[]> perm;
-
-// the number of elements of the group that acts on [N] (and thus on MacP)
-static int sizeofgroup;
-
-// the list of elements of the group, seen as a subgroup of the permutation
-// group
-static unsigned char **action;
+#include "groups.h"
+#include "stats.h"
 
 void showbits(unsigned int *plus) // prints a list if integers in the binary
                                   // representation (smallest bit on the right)
@@ -113,6 +104,8 @@ int weakmap(
 
 // checks whether the oriented matroids M1 and M2 are the same
 int isequal(const OM &M1, const OM &M2) {
+  statcount(stat_isequal);
+
   int i, good;
   good = 0;
   for (i = 0; i < nr_ints; i++) // chi_1==chi_2
@@ -908,15 +901,16 @@ char b2prime(const OM &M, char sign, std::array<unsigned char, R> X,
   return 0;
 }
 
-// checks chirotope axioms, see "Oriented matroids" BLSWZ, Definition 3.5.3
-// returns 0 if it is not a chirotope, 1 if it is a chirotope
-char ischirotope(const OM &M) {
-  long long int h;
-
+// checks that no basis is both positive and negative and (B0), returns 0 if
+// one of them fails
+static char checksigns(const OM &M) {
   for (size_t k = 0; k < nr_ints; k++) {
     if (M.plus[k] &
         M.minus[k]) // if the same basis is both positive and negative
+    {
+      statcount(stat_reject_plusminus);
       return 0;
+    }
   }
 
   size_t k;
@@ -925,74 +919,192 @@ char ischirotope(const OM &M) {
       break;
   }
 
-  if (k == nr_ints)
+  if (k == nr_ints) {
+    statcount(stat_reject_b0);
     return 0;
+  }
 
-  //(B2') Lemma 3.5.4
+  return 1;
+}
+
+// the sign of the basis with index a, without checking that it is not both
+// positive and negative
+static char basissign(const OM &M, size_t a) {
+  unsigned int h = 1u << (a & 31);
+  if (M.plus[a >> 5] & h)
+    return 1;
+  if (M.minus[a >> 5] & h)
+    return -1;
+  return 0;
+}
+
+// checks (B2') for the bases a and b, both of them nonzero
+static char checkpair(const OM &M, size_t a, size_t b) {
   std::array<unsigned char, R> x;
   std::array<unsigned char, R> y;
 
-  char sign;
-  int pi, pj, mi, mj;
+  //\chi(x_1,x_2,x_3)* \chi(y_1,y_2,y_3)
+  char sign = static_cast<char>(basissign(M, a) * basissign(M, b));
 
-  for (k = 0; k < nr_ints; k++) {
-    size_t limit_i = (k == nr_ints) ? B & 31 : 32;
-
-    for (size_t i = 0; i < limit_i; i++) {
-
-      h = 1u << i;
-      pi = M.plus[k] & h;  // pi!=0 iff \chi(bases[i])=1
-      mi = M.minus[k] & h; // mi!=0 iff \chi(bases[i])=-1
-      if ((pi == 0) &&
-          (mi ==
-           0)) //\chi(bases[i])=0, we do not have to worry about this basis
-        continue;
-
-      for (size_t l = k; l < nr_ints; l++) {
-
-        auto j = (l == k) ? i + 1 : 0;
-        size_t limit_j = (l == nr_ints - 1) ? B & 31 : 32;
-
-        for (; j < limit_j; j++) {
-          h = 1u << j;
-          pj = M.plus[l] & h;
-          mj = M.minus[l] & h;
-          if (pj == 0 && mj == 0)
-            continue;
-
-          if ((pi && mj) ||
-              (mi && pj)) //\chi(x_1,x_2,x_3)* \chi(y_1,y_2,y_3)=-1
-            sign = -1;
-          else if ((pi && pj) ||
-                   (mi && mj)) //\chi(x_1,x_2,x_3)* \chi(y_1,y_2,y_3)=1
-            sign = 1;
-
-          for (size_t p = 0; p < R;
-               p++) // we have to check B2' for all permutations
-                    // of x1,x2,x3, but it suffices to have all
-                    // entries of x in the first position
-          {
-            for (size_t q = 0; q < R; q++) {
-              x[q] = bases[i + (k << 5), q];
-              y[q] = bases[j + (l << 5), q];
-            }
-            x[0] = bases[i + (k << 5), p];
-            x[p] = bases[i + (k << 5), 0];
+  for (size_t p = 0; p < R;
+       p++) // we have to check B2' for all permutations
+            // of x1,x2,x3, but it suffices to have all
+            // entries of x in the first position
+  {
+    for (size_t q = 0; q < R; q++) {
+      x[q] = bases[a, q];
+      y[q] = bases[b, q];
+    }
+    x[0] = bases[a, p];
+    x[p] = bases[a, 0];
 
-            if (p == 1)
-              sign = -sign;
+    if (p == 1)
+      sign = -sign;
 
-            if (b2prime(M, sign, x, y) == 0) // checks B2'
-              return 0;
-          }
-        }
-      }
+    if (b2prime(M, sign, x, y) == 0) // checks B2'
+    {
+      statcount(stat_reject_b2prime);
+      return 0;
     }
   }
 
   return 1;
 }
 
+// the three-term Grassmann-Pluecker relations: for every set X of R-2
+// elements and a < b < c < d not in X the products
+// chi(X,a,b) chi(X,c,d), -chi(X,a,c) chi(X,b,d) and chi(X,a,d) chi(X,b,c)
+std::vector<Relation> makerelations() {
+  std::vector<Relation> relations;
+  if (R < 2)
+    return relations;
+
+  // the basis of X together with e and f, and the sign of sorting it
+  auto basis = [](const std::array<unsigned char, R> &X, int e, int f,
+                  int &b) {
+    std::array<unsigned char, R> x = X;
+    x[R - 2] = static_cast<unsigned char>(e);
+    x[R - 1] = static_cast<unsigned char>(f);
+    auto [y, sign] = sort(x);
+    b = ind(y);
+    return sign;
+  };
+
+  for (unsigned int mask = 0; mask < 1u << N; mask++) {
+    if (std::popcount(mask) != R - 2)
+      continue;
+
+    std::array<unsigned char, R> X{};
+    int rest[N], nr_rest = 0;
+    for (int e = 0, k = 0; e < N; e++)
+      if (mask >> e & 1)
+        X[static_cast<size_t>(k++)] = static_cast<unsigned char>(e);
+      else
+        rest[nr_rest++] = e;
+
+    for (int a = 0; a < nr_rest; a++)
+      for (int b = a + 1; b < nr_rest; b++)
+        for (int c = b + 1; c < nr_rest; c++)
+          for (int d = c + 1; d < nr_rest; d++) {
+            const int pairs[3][4] = {{a, b, c, d}, {a, c, b, d}, {a, d, b, c}};
+            Relation rel;
+            for (int t = 0; t < 3; t++) {
+              const int *p = pairs[t];
+              int s1 = basis(X, rest[p[0]], rest[p[1]], rel.bases[t][0]);
+              int s2 = basis(X, rest[p[2]], rest[p[3]], rel.bases[t][1]);
+              rel.sign[t] = (t == 1 ? -1 : 1) * s1 * s2;
+            }
+            relations.push_back(rel);
+          }
+  }
+
+  return relations;
+}
+
+DualTables makedualtables() {
+  // the (N-R)-subsets in lexicographic order: the first one contains the
+  // smallest element in which they differ
+  std::vector<unsigned int> subsets;
+  for (unsigned int mask = 0; mask < 1u << N; mask++)
+    if (std::popcount(mask) == N - R)
+      subsets.push_back(mask);
+  std::sort(subsets.begin(), subsets.end(), [](unsigned int x, unsigned int y) {
+    return (x & ((x ^ y) & -(x ^ y))) != 0;
+  });
+  std::vector<int> place(1u << N, -1);
+  for (size_t i = 0; i < subsets.size(); i++)
+    place[subsets[i]] = static_cast<int>(i);
+
+  DualTables T;
+  for (size_t b = 0; b < B; b++) {
+    unsigned int X = 0;
+    for (size_t j = 0; j < R; j++)
+      X |= 1u << bases[b, j];
+    unsigned int complement = ((1u << N) - 1) & ~X;
+
+    // the inversions of X followed by its complement
+    int inversions = 0;
+    for (size_t j = 0; j < R; j++)
+      inversions += std::popcount(complement & ((1u << bases[b, j]) - 1));
+
+    T.index[b] = place[complement];
+    T.sign[b] = inversions & 1 ? -1 : 1;
+  }
+
+  return T;
+}
+
+OM dualOM(const OM &M, const DualTables &T) {
+  OM X;
+  for (int b = 0; b < B; b++) {
+    int i = T.index[static_cast<size_t>(b)];
+    unsigned int plus = M.plus[i >> 5] >> (i & 31) & 1;
+    unsigned int minus = M.minus[i >> 5] >> (i & 31) & 1;
+    if (T.sign[static_cast<size_t>(b)] < 0)
+      std::swap(plus, minus);
+    X.plus[b >> 5] |= plus << (b & 31);
+    X.minus[b >> 5] |= minus << (b & 31);
+  }
+  return X;
+}
+
+// checks chirotope axioms, see "Oriented matroids" BLSWZ, Definition 3.5.3
+// returns 0 if it is not a chirotope, 1 if it is a chirotope
+char ischirotope(const OM &M) {
+  statcount(stat_ischirotope);
+
+  if (checksigns(M) == 0)
+    return 0;
+
+  //(B2') Lemma 3.5.4
+  for (size_t a = 0; a < B; a++) {
+    if (basissign(M, a) == 0) // we do not have to worry about this basis
+      continue;
+    for (size_t b = a + 1; b < B; b++)
+      if (basissign(M, b) != 0 && checkpair(M, a, b) == 0)
+        return 0;
+  }
+
+  return 1;
+}
+
+char isinvariantchirotope(const OM &M,
+                          const std::vector<std::array<int, 2>> &pairs) {
+  statcount(stat_ischirotope);
+
+  if (checksigns(M) == 0)
+    return 0;
+
+  for (const auto &P : pairs) {
+    size_t a = static_cast<size_t>(P[0]), b = static_cast<size_t>(P[1]);
+    if (basissign(M, a) != 0 && basissign(M, b) != 0 &&
+        checkpair(M, a, b) == 0)
+      return 0;
+  }
+
+  return 1;
+}
+
 void standardizeOM(struct OM *M) // we store OMs in such a way that the
                                  // lexicographically largest basis is positive
 {
@@ -1015,43 +1127,27 @@ void standardizeOM(struct OM *M) // we store OMs in such a way that the
   }
 }
 
-// makes all permutations of N elements and stores them in perm
-void permutations(char *p, int l) {
-  if (l == N) {
+// all permutations of N elements, made on the first call; the table is only
+// read afterwards, so it is shared by all threads
+const std::vector<Permutation> &allpermutations() {
+  static const std::vector<Permutation> perm = [] {
+    std::vector<Permutation> all;
+    Permutation p;
     for (size_t i = 0; i < N; i++)
-      perm[w][i] = p[i];
-    w++;
-    return;
-  }
-
-  for (int j = l; j < N; j++) {
-    auto x = p[l];
-    p[l] = p[j];
-    p[j] = x;
-    permutations(p, l + 1);
-    x = p[l];
-    p[l] = p[j];
-    p[j] = x;
-  }
-  return;
-}
-
-void makepermutations() // makes all permutations on N
-{
-  perm = std::make_unique<std::unique_ptr<char[]>[]>(factorial(N));
-  for (size_t s = 0; s < factorial(N); s++)
-    perm[s] = std::make_unique<char[]>(N);
-
-  char p[N];
-  for (size_t i = 0; i < N; i++)
-    p[i] = static_cast<char>(i);
-  w = 0;
-  permutations(&p[0], 0);
+      p[i] = static_cast<unsigned char>(i);
+    do
+      all.push_back(p);
+    while (std::next_permutation(p.begin(), p.end()));
+    return all;
+  }();
+  return perm;
 }
 
 // given an OM, it transforms it into a new one - permutes the labels of the
 // elements s[] is an array of length N that stores the permutation
 struct OM permute(const OM &M, unsigned char s[]) {
+  statcount(stat_permute);
+
   int i, j;
   int b[B];     // b[i] is the index of the i-th basis after permutation
   char sign[B]; // sign[i] stores the sign of the permutation on the basis i
@@ -1100,73 +1196,131 @@ struct OM permute(const OM &M, unsigned char s[]) {
   return X;
 }
 
-// returns 1 if the OM M is fixed under the given group action
-int isfixed(struct OM M) {
-  int i;
+// elementmasks.m[e] is the set of bases that contain the element e
+struct ElementMasks {
+  unsigned int m[N][nr_ints];
+};
+
+static constexpr ElementMasks elementmasks = [] {
+  ElementMasks masks{};
+  for (int i = 0; i < B; i++)
+    for (int j = 0; j < R; j++)
+      masks.m[bases_backing[static_cast<size_t>(i * R + j)]][i >> 5] |=
+          1u << (i & 31);
+  return masks;
+}();
+
+// a basis changes its sign iff it contains an odd number of reoriented elements
+OM reorient(const OM &M, unsigned int s) {
+  unsigned int flip[nr_ints] = {};
+  for (int e = 0; e < N; e++)
+    if (s & (1u << e))
+      for (int i = 0; i < nr_ints; i++)
+        flip[i] ^= elementmasks.m[e][i];
+
   OM X;
+  for (int i = 0; i < nr_ints; i++) {
+    X.plus[i] = (M.plus[i] & ~flip[i]) | (M.minus[i] & flip[i]);
+    X.minus[i] = (M.minus[i] & ~flip[i]) | (M.plus[i] & flip[i]);
+  }
+  return X;
+}
 
-  for (i = 1; i < sizeofgroup; i++) {
-    X = permute(M, action[i]);
-    if (isequal(X, M) == 0) {
-      return 0;
+int compareOM(const OM &M1, const OM &M2) {
+  for (int i = nr_ints - 1; i >= 0; i--)
+    if (M1.plus[i] != M2.plus[i])
+      return M1.plus[i] < M2.plus[i] ? -1 : 1;
+  for (int i = nr_ints - 1; i >= 0; i--)
+    if (M1.minus[i] != M2.minus[i])
+      return M1.minus[i] < M2.minus[i] ? -1 : 1;
+  return 0;
+}
+
+// the smaller of chi and -chi
+static OM normalizesign(const OM &M) {
+  OM X;
+  for (int i = 0; i < nr_ints; i++) {
+    X.plus[i] = M.minus[i];
+    X.minus[i] = M.plus[i];
+  }
+  return compareOM(X, M) < 0 ? X : M;
+}
+
+// first all permutations, then all reorientations of every permuted OM; the
+// reorientation of all elements only changes the sign, so the last element is
+// never reoriented
+std::vector<OM> makeclass(const OM &M) {
+  std::vector<OM> oms;
+  for (Permutation s : allpermutations()) {
+    OM X = permute(M, s.data());
+
+    for (unsigned int x = 0; x < 1u << (N - 1); x++)
+      oms.push_back(normalizesign(reorient(X, x)));
+  }
+
+  std::sort(oms.begin(), oms.end(),
+            [](const OM &a, const OM &b) { return compareOM(a, b) < 0; });
+  oms.erase(std::unique(oms.begin(), oms.end(),
+                        [](const OM &a, const OM &b) {
+                          return compareOM(a, b) == 0;
+                        }),
+            oms.end());
+  return oms;
+}
+
+OM canonicalOM(const OM &M) {
+  long long stabilizer;
+  return canonicalOM(M, stabilizer);
+}
+
+// the permutations and reorientations that give the smallest OM so far are
+// counted, they are a coset of the stabilizer
+OM canonicalOM(const OM &M, long long &stabilizer) {
+  OM C = normalizesign(M);
+  stabilizer = 0;
+  for (Permutation s : allpermutations()) {
+    OM X = permute(M, s.data());
+
+    for (unsigned int x = 0; x < 1u << (N - 1); x++) {
+      OM Y = normalizesign(reorient(X, x));
+      int c = compareOM(Y, C);
+      if (c < 0) {
+        C = Y;
+        stabilizer = 1;
+      } else if (c == 0)
+        stabilizer++;
     }
   }
-  return 1;
+  return C;
 }
 
 void writeOM(const OM &om, FILE *f) { showchirotope(om, f); }
 
+// reads the next chirotope from f, lines that are not chirotopes (e.g. the
+// headers of our files) are skipped; returns 0 at the end of the file
 int readOM(struct OM *om, FILE *f) {
-  for (int j = 0; j != nr_ints - 1; ++j) {
-    unsigned int plus = 0;
-    unsigned int minus = 0;
-    for (int i = 0; i != 32; ++i) {
-      char c = static_cast<char>(fgetc(f));
-
-      switch (c) {
-      case '+':
-        plus |= 1 << i;
-        break;
-      case '-':
-        minus |= 1 << i;
-        break;
-      case '0':
-        break;
-      default:
-        assert(false);
-      }
-    }
-    om->minus[j] = minus;
-    om->plus[j] = plus;
-  }
+  char text[300];
 
-  unsigned int plus = 0;
-  unsigned int minus = 0;
-  for (int i = 0; i != (B & 31); ++i) {
-    char c = static_cast<char>(fgetc(f));
+  while (fgets(text, 300, f) != NULL) {
+    auto len = strcspn(text, "\r\n");
+    if (len != B || strspn(text, "+-0") != B)
+      continue;
 
-    switch (c) {
-    case '+':
-      plus |= 1 << i;
-      break;
-    case '-':
-      minus |= 1 << i;
-      break;
-    case '0':
-      break;
-    default:
-      assert(false);
+    for (int i = 0; i < nr_ints; i++) {
+      om->plus[i] = 0;
+      om->minus[i] = 0;
+    }
+
+    for (int j = 0; j < B; j++) {
+      if (text[j] == '+')
+        om->plus[j >> 5] |= 1u << (j & 31);
+      else if (text[j] == '-')
+        om->minus[j >> 5] |= 1u << (j & 31);
     }
+
+    return 1;
   }
-  om->minus[nr_ints - 1] = minus;
-  om->plus[nr_ints - 1] = plus;
 
-  return 1;
+  return 0;
 }
 
-void removegroupaction() {
-  int i;
-  for (i = 0; i < sizeofgroup; i++)
-    free(action[i]);
-  free(action);
-}
@@ -1,14 +1,23 @@
 #ifndef OMs_H
 #define OMs_H
 
+#include <array>
 #include <mdspan>
 #include <stdio.h>
+#include <vector>
 
-// Oriented matroids of rank R on N elements
+// Oriented matroids of rank R on N elements, the defaults can be overridden
+// with -DOM_RANK=... -DOM_ELEMENTS=... (e.g. for the benchmarks)
+#ifndef OM_RANK
+#define OM_RANK 2
+#endif
+#ifndef OM_ELEMENTS
+#define OM_ELEMENTS 8
+#endif
 
 // The code works only for B<=64!
-inline constexpr int R = 2; // rank
-inline constexpr int N = 8; // the number of elements
+inline constexpr int R = OM_RANK;     // rank
+inline constexpr int N = OM_ELEMENTS; // the number of elements
 
 constexpr int calculate_bases_count() {
   int bases_count = 1;
@@ -35,7 +44,7 @@ constexpr int calculate_nr_ints() {
 // minus) of a chirotope
 inline constexpr int nr_ints = calculate_nr_ints();
 
-static_assert(nr_ints <= 4, "Requires more ints than available in OM");
+static_assert(nr_ints <= 8, "Requires more ints than available in OM");
 
 // makes the list of all posible bases a chirotope could have, bases are 012,
 // 013,...
@@ -115,17 +124,49 @@ char axB2(const OM &M, char sign, char s1, char s2, int in1, int in2);
 char b2prime(const OM &M, char sign, std::array<unsigned char, R> X,
              std::array<unsigned char, R> Y);
 
+// a three-term Grassmann-Pluecker relation: the t-th product is
+// sign[t] * chi(bases[t][0]) * chi(bases[t][1]); in every chirotope the three
+// products are all zero, or one is positive and one is negative
+struct Relation {
+  int bases[3][2];
+  int sign[3];
+};
+
+// all three-term Grassmann-Pluecker relations of rank R on N elements
+std::vector<Relation> makerelations();
+
+// the duality between the oriented matroids of rank N-R and of rank R on the
+// same elements: chi*(X) = sign(X, X^c) chi(X^c) for every basis X of rank R,
+// where X^c is the complement of X and sign(X, X^c) the sign of the
+// permutation that sorts X followed by X^c; the complement of the b-th basis
+// is the index[b]-th (N-R)-subset in lexicographic order
+struct DualTables {
+  std::array<int, B> index;
+  std::array<int, B> sign;
+};
+
+DualTables makedualtables();
+
+// the dual of M, an oriented matroid of rank N-R whose bit i stands for the
+// i-th (N-R)-subset in lexicographic order (as in the files of rank N-R)
+OM dualOM(const OM &M, const DualTables &T);
+
 // checks chirotope axioms, see "Oriented matroids" BLSWZ, Definition 3.5.3
 char ischirotope(const OM &M);
 
+// the same as ischirotope for an M that is fixed up to sign under a group of
+// permutations: the pairs of bases that fail (B2') are then a union of
+// orbits, so it checks (B2') only for the given pairs (a, b), a < b, one from
+// each orbit of the pairs that ischirotope looks at
+char isinvariantchirotope(const OM &M,
+                          const std::vector<std::array<int, 2>> &pairs);
+
 // we store OMs in such a way that the largest basis is positive
 void standardizeOM(struct OM *M);
 
-// recursively makes all permutations of N elements and stores them in perm
-void permutations(char *p, int l);
-
-// makes all permutations on N
-void makepermutations();
+// all N! permutations of the elements (p[e] is the image of the element e)
+// in lexicographic order
+const std::vector<std::array<unsigned char, N>> &allpermutations();
 
 // computes n!
 constexpr int factorial(int n) {
@@ -140,13 +181,31 @@ constexpr int factorial(int n) {
 // elements, the permutation is given by s
 OM permute(const OM &M, unsigned char s[]);
 
-// checks whether this OM is fixed under the group action
-int isfixed(struct OM M);
+// reorients the elements in the set s (bit e stands for the element e)
+OM reorient(const OM &M, unsigned int s);
+
+// compares the plus and then the minus of M1 and M2, starting with the largest
+// bases, returns -1, 0 or 1
+int compareOM(const OM &M1, const OM &M2);
+
+// compareOM(M1, M2) < 0, for sorting and sets of oriented matroids
+inline int lessOM(const OM &M1, const OM &M2) { return compareOM(M1, M2) < 0; }
 
-// frees the memory that is allocated for the group action
-void removegroupaction();
+// makes all oriented matroids in the permutation/reorientation class of M,
+// each stored as the smaller of chi and -chi, sorted by compareOM
+std::vector<OM> makeclass(const OM &M);
+
+// the smallest oriented matroid in the permutation/reorientation class of M,
+// the same for all elements of the class
+OM canonicalOM(const OM &M);
+
+// the same, and the number of the permutations and reorientations of
+// makeclass() that map M to it, which is the order of the stabilizer of M
+OM canonicalOM(const OM &M, long long &stabilizer);
 
 void writeOM(const OM &, FILE *);
+
+// reads the next chirotope, skipping header lines, returns 0 at the end of file
 int readOM(struct OM *, FILE *);
 
 #endif // OMs_H
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "OMs.h"
+
+// Microbenchmarks of the functions in OMs.cpp for oriented matroids of rank R
+// on N elements (the benchmark is built for several shapes, see
+// CMakeLists.txt). The inputs are read from catalog files or generated
+// workloads (see realizable_chirotopes.cpp) given on the command line; without
+// inputs the uniform oriented matroids in the class of the alternating
+// chirotope are used.
+//
+// Every kernel is first run until it takes at least min_seconds (this is also
+// the warm-up), then the same number of calls is timed repetitions times. The
+// median in ns per call and calls per second are printed and written to
+// benchmark_rankR_Nelements.json (or the file given with -o).
+
+using Clock = std::chrono::steady_clock;
+
+static const double min_seconds = 0.05;
+
+struct Result {
+  const char *name;
+  unsigned long long ops; // calls per repetition
+  double median, min, max; // ns per call
+};
+
+static std::vector<Result> results;
+static int repetitions = 5;
+static volatile unsigned long long sink; // keeps the results of the calls
+
+// times ops calls of f, returns the time in seconds
+template <class F> static double measure(F &f, unsigned long long ops) {
+  unsigned long long s = 0;
+  auto begin = Clock::now();
+  for (unsigned long long i = 0; i < ops; i++)
+    s += f(i);
+  double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+  sink = sink + s;
+  return seconds;
+}
+
+template <class F> static void bench(const char *name, F f) {
+  unsigned long long ops = 1;
+  while (measure(f, ops) < min_seconds && ops < 1ull << 40)
+    ops <<= 1;
+
+  std::vector<double> ns;
+  for (int r = 0; r < repetitions; r++)
+    ns.push_back(measure(f, ops) * 1e9 / static_cast<double>(ops));
+  std::sort(ns.begin(), ns.end());
+
+  Result res = {name, ops, ns[ns.size() / 2], ns.front(), ns.back()};
+  results.push_back(res);
+
+  printf("%-24s %14.1f ns/op %16.0f items/s\n", name, res.median,
+         1e9 / res.median);
+  fflush(stdout);
+}
+
+static void writeresults(const char *name, size_t nr_inputs) {
+  FILE *out = fopen(name, "w");
+  if (out == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", name);
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(out, "{\n  \"rank\": %d,\n  \"elements\": %d,\n  \"bases\": %d,\n",
+          R, N, B);
+  fprintf(out, "  \"inputs\": %zu,\n  \"repetitions\": %d,\n", nr_inputs,
+          repetitions);
+  fprintf(out, "  \"benchmarks\": [");
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result &res = results[i];
+    fprintf(out,
+            "%s\n    {\"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.2f, "
+            "\"min_ns_per_op\": %.2f, \"max_ns_per_op\": %.2f, "
+            "\"items_per_second\": %.1f}",
+            i ? "," : "", res.name, res.ops, res.median, res.min, res.max,
+            1e9 / res.median);
+  }
+  fprintf(out, "\n  ]\n}\n");
+  fclose(out);
+}
+
+// the alternating chirotope, all bases are positive
+static OM alternating() {
+  OM M;
+  for (int i = 0; i < B; i++)
+    M.plus[i >> 5] |= 1u << (i & 31);
+  return M;
+}
+
+int main(int argc, char *argv[]) {
+  size_t nr_items = 4096; // the size of the workload
+  char output[300];
+  sprintf(output, "benchmark_rank%d_%delements.json", R, N);
+
+  int a = 1;
+  for (; a + 1 < argc && argv[a][0] == '-'; a += 2) {
+    if (strcmp(argv[a], "-r") == 0)
+      repetitions = std::max(1, atoi(argv[a + 1]));
+    else if (strcmp(argv[a], "-n") == 0)
+      nr_items = static_cast<size_t>(std::max(1, atoi(argv[a + 1])));
+    else if (strcmp(argv[a], "-o") == 0)
+      snprintf(output, sizeof(output), "%s", argv[a + 1]);
+    else
+      break;
+  }
+  if (a < argc && argv[a][0] == '-') {
+    printf("Usage: %s [-r repetitions] [-n items] [-o results.json] "
+           "[input files...]\n",
+           argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  std::mt19937_64 rng(20240917); // the same workload in every run
+
+  // the accepted inputs: every oriented matroid from the files, thinned out
+  // evenly to nr_items so that all numbers of bases are represented
+  std::vector<OM> accepted;
+  OM M;
+  for (; a < argc; a++) {
+    FILE *in = fopen(argv[a], "r");
+    if (in == NULL) {
+      fprintf(stderr, "error fopen():  Could not open text file %s.\n",
+              argv[a]);
+      exit(EXIT_FAILURE);
+    }
+    while (readOM(&M, in) != 0)
+      accepted.push_back(M);
+    fclose(in);
+  }
+  size_t nr_inputs = accepted.size();
+
+  if (accepted.size() > nr_items) {
+    std::vector<OM> sample;
+    for (size_t i = 0; i < nr_items; i++)
+      sample.push_back(accepted[i * accepted.size() / nr_items]);
+    accepted.swap(sample);
+  }
+
+  if (accepted.empty()) {
+    OM U = alternating();
+    for (size_t i = 0; i < nr_items; i++) {
+      unsigned char s[N];
+      for (int j = 0; j < N; j++)
+        s[j] = static_cast<unsigned char>(j);
+      std::shuffle(s, s + N, rng);
+      accepted.push_back(
+          reorient(permute(U, s), static_cast<unsigned int>(rng())));
+    }
+  }
+
+  // the rejected inputs: an accepted one with one sign changed (this is
+  // rejected by B2') or with random signs
+  std::vector<OM> rejected;
+  for (size_t i = 0; rejected.size() < accepted.size(); i++) {
+    OM X = accepted[i % accepted.size()];
+    if (i & 1) {
+      int b = static_cast<int>(rng() % B);
+      unsigned int bit = 1u << (b & 31);
+      if ((X.plus[b >> 5] | X.minus[b >> 5]) & bit) {
+        X.plus[b >> 5] ^= bit;
+        X.minus[b >> 5] ^= bit;
+      }
+    } else
+      for (int b = 0; b < B; b++) {
+        unsigned int bit = 1u << (b & 31);
+        X.plus[b >> 5] &= ~bit;
+        X.minus[b >> 5] &= ~bit;
+        auto r = rng() % 3;
+        if (r == 1)
+          X.plus[b >> 5] |= bit;
+        else if (r == 2)
+          X.minus[b >> 5] |= bit;
+      }
+    if (ischirotope(X) == 0)
+      rejected.push_back(X);
+    if (i > 64 * accepted.size()) // e.g. for N=R there is nothing to reject
+      break;
+  }
+
+  // random permutations and R-tuples for permute, sort and ind
+  std::vector<std::array<unsigned char, N>> perms(nr_items);
+  for (auto &s : perms) {
+    for (int j = 0; j < N; j++)
+      s[static_cast<size_t>(j)] = static_cast<unsigned char>(j);
+    std::shuffle(s.begin(), s.end(), rng);
+  }
+  std::vector<std::array<unsigned char, R>> tuples(nr_items);
+  for (size_t i = 0; i < nr_items; i++)
+    for (int j = 0; j < R; j++)
+      tuples[i][static_cast<size_t>(j)] = perms[i][static_cast<size_t>(j)];
+
+  std::vector<std::array<unsigned char, R>> sorted(tuples.size());
+  for (size_t i = 0; i < tuples.size(); i++)
+    sorted[i] = sort(tuples[i]).first;
+
+  size_t n = accepted.size();
+  printf("rank %d, %d elements, %d bases: %zu accepted and %zu rejected "
+         "inputs (%zu read)\n",
+         R, N, B, n, rejected.size(), nr_inputs);
+
+  bench("ischirotope_accepted", [&](unsigned long long i) {
+    return static_cast<unsigned long long>(ischirotope(accepted[i % n]));
+  });
+  if (!rejected.empty())
+    bench("ischirotope_rejected", [&](unsigned long long i) {
+      return static_cast<unsigned long long>(
+          ischirotope(rejected[i % rejected.size()]));
+    });
+  bench("permute", [&](unsigned long long i) {
+    OM X = permute(accepted[i % n], perms[i % nr_items].data());
+    return static_cast<unsigned long long>(X.plus[0]);
+  });
+  bench("isequal", [&](unsigned long long i) {
+    return static_cast<unsigned long long>(
+        isequal(accepted[i % n], accepted[(i + 1) % n]));
+  });
+  bench("weakmap", [&](unsigned long long i) {
+    return static_cast<unsigned long long>(
+        weakmap(accepted[i % n], accepted[(i + 1) % n]));
+  });
+  bench("ind", [&](unsigned long long i) {
+    return static_cast<unsigned long long>(ind(sorted[i % nr_items]));
+  });
+  bench("sort", [&](unsigned long long i) {
+    auto [x, sign] = sort(tuples[i % nr_items]);
+    return static_cast<unsigned long long>(x[0] + sign);
+  });
+  bench("reorient", [&](unsigned long long i) {
+    OM X = reorient(accepted[i % n], static_cast<unsigned int>(i));
+    return static_cast<unsigned long long>(X.plus[0]);
+  });
+
+  FILE *f = tmpfile();
+  if (f == NULL) {
+    fprintf(stderr, "error tmpfile():  Could not open a temporary file.\n");
+    exit(EXIT_FAILURE);
+  }
+  bench("writeOM", [&](unsigned long long i) {
+    if (i % n == 0)
+      rewind(f);
+    writeOM(accepted[i % n], f);
+    return 0ull;
+  });
+  fflush(f);
+  rewind(f);
+  bench("readOM", [&](unsigned long long) {
+    if (readOM(&M, f) == 0) {
+      rewind(f);
+      readOM(&M, f);
+    }
+    return static_cast<unsigned long long>(M.plus[0]);
+  });
+  fclose(f);
+
+  if (N <= 8) { // both go through all N! permutations
+    bench("makeclass", [&](unsigned long long i) {
+      return static_cast<unsigned long long>(
+          makeclass(accepted[i % n]).size());
+    });
+    bench("canonicalOM", [&](unsigned long long i) {
+      OM X = canonicalOM(accepted[i % n]);
+      return static_cast<unsigned long long>(X.plus[0]);
+    });
+  }
+
+  writeresults(output, nr_inputs);
+
+  return 0;
+}
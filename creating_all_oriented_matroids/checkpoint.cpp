@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+volatile sig_atomic_t stop_requested = 0;
+
+static void stophandler(int) { stop_requested = 1; }
+
+void installstophandler() {
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = stophandler;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGTERM, &sa, NULL);
+  sigaction(SIGINT, &sa, NULL);
+}
+
+int writecheckpoint(const char *name, const Checkpoint &C) {
+  char text[300];
+  snprintf(text, sizeof(text), "%s.tmp", name);
+
+  FILE *f = fopen(text, "w");
+  if (f == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", text);
+    return 0;
+  }
+
+  fprintf(f, "counter %llu\ncount %lld\noffset %ld\nprefix %zu", C.counter,
+          C.count, C.offset, C.prefix.size());
+  for (signed char x : C.prefix)
+    fprintf(f, " %d", x);
+  fputc('\n', f);
+
+  // the data has to be on the disk before the rename replaces the old
+  // checkpoint
+  if (fflush(f) != 0 || fsync(fileno(f)) != 0) {
+    fclose(f);
+    return 0;
+  }
+  fclose(f);
+
+  return rename(text, name) == 0;
+}
+
+int readcheckpoint(const char *name, Checkpoint &C) {
+  FILE *f = fopen(name, "r");
+  if (f == NULL)
+    return 0;
+
+  size_t len;
+  int ok = fscanf(f, "counter %llu count %lld offset %ld prefix %zu",
+                  &C.counter, &C.count, &C.offset, &len) == 4;
+
+  C.prefix.clear();
+  for (size_t i = 0; ok && i < len; i++) {
+    int x;
+    ok = fscanf(f, "%d", &x) == 1;
+    C.prefix.push_back(static_cast<signed char>(x));
+  }
+
+  fclose(f);
+  return ok;
+}
+
+long outputoffset(FILE *out) {
+  fflush(out);
+  return ftell(out);
+}
+
+int truncateoutput(FILE *out, long offset) {
+  fflush(out);
+  if (ftruncate(fileno(out), offset) != 0)
+    return 0;
+  return fseek(out, 0, SEEK_END) == 0;
+}
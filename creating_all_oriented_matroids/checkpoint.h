@@ -0,0 +1,38 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <signal.h>
+#include <stdio.h>
+#include <vector>
+
+// The state of a long enumeration, written from time to time so that the run
+// can be continued with --resume after a crash or after it was stopped.
+struct Checkpoint {
+  unsigned long long counter = 0; // the next subset/input line to process
+  long long count = 0;            // the number of objects written so far
+  long offset = 0;                // the size of the output file at that time
+  std::vector<signed char> prefix; // the last finished branch of a recursion
+};
+
+// set by SIGTERM (and SIGINT), the enumeration should write a checkpoint and
+// stop as soon as it sees it
+extern volatile sig_atomic_t stop_requested;
+
+// installs the handler for SIGTERM and SIGINT
+void installstophandler();
+
+// writes the checkpoint to name.tmp and renames it to name, so name always
+// contains a complete checkpoint; returns 0 on failure
+int writecheckpoint(const char *name, const Checkpoint &C);
+
+// reads the checkpoint, returns 0 if there is none
+int readcheckpoint(const char *name, Checkpoint &C);
+
+// flushes out and returns its size
+long outputoffset(FILE *out);
+
+// cuts the output back to the given size (everything after the checkpoint is
+// written again) and moves to its end, returns 0 on failure
+int truncateoutput(FILE *out, long offset);
+
+#endif // CHECKPOINT_H
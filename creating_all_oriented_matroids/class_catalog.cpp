@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "OMs.h"
+#include "classes.h"
+#include "hasse.h"
+#include "stats.h"
+
+// This code works with the catalog of the permutation/reorientation classes
+// of MacP(R,N) (see classes.h) instead of the files with all oriented
+// matroids, which are N! 2^(N-1) times larger for most classes:
+// --make reads oriented matroids (e.g. the lower cones of lower_cones.cpp or
+//   the old catalog files) and writes the catalog of their classes to
+//   classes_rankR_Nelements.txt,
+// --count prints the number of oriented matroids for every number of bases,
+//   computed from the orders of the stabilizers (class size = N! 2^(N-1) /
+//   stabilizer); the files can also be lower cones or other lists of
+//   oriented matroids, whose classes are then found in memory without
+//   writing anything, a quick check of the totals of find_all_OMs.c,
+// --expand writes all oriented matroids, sorted by the number of bases, to
+//   the files all_OMs_rankR_Nelements_kbases.txt of find_all_OMs.c,
+// --dual streams the catalog of MacP(N-R,N), made by this code for rank N-R,
+//   and writes the catalog of MacP(R,N) with the dual classes (see dualOM()),
+//   which have the same stabilizers; so e.g. the ranks 5 and 6 on 8 elements
+//   come from the cheap rank 3 and rank 2 runs.
+
+static FILE *openfile(const char *name, const char *mode) {
+  FILE *f = fopen(name, mode);
+  if (f == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", name);
+    exit(EXIT_FAILURE);
+  }
+  return f;
+}
+
+static std::vector<ClassEntry> readcatalog(const char *name) {
+  FILE *in = openfile(name, "r");
+  std::vector<ClassEntry> classes;
+  if (readclasses(classes, in) == 0) {
+    fprintf(stderr, "The file %s is not a catalog of classes of MacP(%d,%d).\n",
+            name, R, N);
+    exit(EXIT_FAILURE);
+  }
+  fclose(in);
+  return classes;
+}
+
+static void make(int nr_files, char *files[], unsigned int nr_threads) {
+  std::vector<OM> oms;
+  statbegin("reading");
+  if (readcatalogs(oms, nr_files, files) == 0)
+    exit(EXIT_FAILURE);
+  statend(oms.size());
+
+  statbegin("canonical forms");
+  size_t nr_oms = oms.size();
+  std::vector<ClassEntry> classes = makeclasses(std::move(oms), nr_threads);
+  statend(nr_oms);
+
+  char text[300];
+  sprintf(text, "classes_rank%d_%delements.txt", R, N);
+  FILE *out = openfile(text, "w");
+  if (writeclasses(classes, out) == 0) {
+    fprintf(stderr, "Could not write the file %s.\n", text);
+    exit(EXIT_FAILURE);
+  }
+  fclose(out);
+
+  printf("%zu oriented matroids in %zu classes\n", nr_oms, classes.size());
+}
+
+// the files are catalogs or lists of oriented matroids, whose classes are
+// found in memory; nothing is written
+static void count(int nr_files, char *files[], unsigned int nr_threads) {
+  std::vector<ClassEntry> classes;
+  std::vector<OM> oms;
+  OM M;
+
+  statbegin("reading");
+  for (int f = 0; f < nr_files; f++) {
+    FILE *in = openfile(files[f], "r");
+    if (!isclasscatalog(in))
+      while (readOM(&M, in) != 0)
+        oms.push_back(M);
+    else if (readclasses(classes, in) == 0) {
+      fprintf(stderr,
+              "The file %s is not a catalog of classes of MacP(%d,%d).\n",
+              files[f], R, N);
+      exit(EXIT_FAILURE);
+    }
+    fclose(in);
+  }
+  statend(oms.size() + classes.size());
+
+  if (!oms.empty()) {
+    statbegin("canonical forms");
+    size_t nr_oms = oms.size();
+    std::vector<ClassEntry> found = makeclasses(std::move(oms), nr_threads);
+    classes.insert(classes.end(), found.begin(), found.end());
+    statend(nr_oms);
+  }
+
+  // a class can be in several files
+  std::sort(classes.begin(), classes.end(),
+            [](const ClassEntry &a, const ClassEntry &b) {
+              return compareOM(a.rep, b.rep) < 0;
+            });
+  classes.erase(std::unique(classes.begin(), classes.end(),
+                            [](const ClassEntry &a, const ClassEntry &b) {
+                              return compareOM(a.rep, b.rep) == 0;
+                            }),
+                classes.end());
+
+  std::map<int, std::pair<long long, long long>> counts; // classes, OMs
+  long long total = 0;
+  for (const ClassEntry &E : classes) {
+    counts[E.nr_bases].first++;
+    counts[E.nr_bases].second += classsize(E);
+    total += classsize(E);
+  }
+
+  for (const auto &[k, c] : counts)
+    printf("%d bases: %lld classes, %lld chirotopes\n", k, c.first, c.second);
+  printf("%lld chirotopes\n", total);
+}
+
+static void expand(const char *name, unsigned int nr_threads) {
+  std::vector<ClassEntry> classes = readcatalog(name);
+  std::map<int, FILE *> files; // the output for every number of bases
+  std::vector<OM> oms;
+  long long total = 0;
+
+  statbegin("expansion");
+  Expansion X = startexpansion(classes, nr_threads, 16);
+  while (nextchunk(X, oms)) {
+    for (const OM &M : oms) {
+      int k = countbases(M);
+      FILE *&out = files[k];
+      if (out == NULL) {
+        char text[300];
+        sprintf(text, "all_OMs_rank%d_%delements_%dbases.txt", R, N, k);
+        out = openfile(text, "w");
+        fprintf(out,
+                "All oriented matroids of rank %d on %d elements with %d "
+                "bases.\n\n",
+                R, N, k);
+      }
+      writeOM(M, out);
+    }
+    total += static_cast<long long>(oms.size());
+    statprogress(X.next, classes.size());
+  }
+  statend(classes.size());
+
+  for (const auto &[k, out] : files)
+    fclose(out);
+
+  printf("%lld chirotopes\n", total);
+}
+
+// the catalog is streamed in chunks, the dual classes are written in the
+// order of the input (which is sorted by the number of bases if the input is,
+// duality keeps the number of bases); the output is renamed at the end, so
+// that a self-dual catalog can be its own input
+static void dual(const char *name, unsigned int nr_threads) {
+  FILE *in = openfile(name, "r");
+  if (readclassheader(in) == 0) {
+    fprintf(stderr, "The file %s is not a catalog of classes of MacP(%d,%d).\n",
+            name, N - R, N);
+    exit(EXIT_FAILURE);
+  }
+
+  char text[300], temporary[310];
+  sprintf(text, "classes_rank%d_%delements.txt", R, N);
+  sprintf(temporary, "%s.tmp", text);
+  FILE *out = openfile(temporary, "w");
+  writeclassheader(out);
+
+  DualTables T = makedualtables();
+  std::vector<ClassEntry> chunk;
+  ClassEntry E;
+  size_t nr_classes = 0;
+  int status = 1;
+
+  statbegin("duals");
+  while (status == 1) {
+    chunk.clear();
+    while (chunk.size() < 16 * static_cast<size_t>(nr_threads) &&
+           (status = readclass(E, in)) == 1)
+      chunk.push_back(E);
+
+    int wrong = status < 0; // a dual that is not a chirotope is wrong as well
+    orderedpool(
+        chunk.size(), nr_threads,
+        [&](size_t k) {
+          OM M = dualOM(chunk[k].rep, T);
+          return ischirotope(M) ? canonicalOM(M) : OM();
+        },
+        [&](size_t k, const OM &M) {
+          if (countbases(M) == 0)
+            wrong = 1;
+          chunk[k].rep = M;
+          writeclass(chunk[k], out);
+        });
+    if (wrong) {
+      fprintf(stderr,
+              "The file %s is not a catalog of classes of MacP(%d,%d).\n",
+              name, N - R, N);
+      fclose(out);
+      remove(temporary);
+      exit(EXIT_FAILURE);
+    }
+
+    nr_classes += chunk.size();
+  }
+  statend(nr_classes);
+  fclose(in);
+
+  if (ferror(out) != 0 || fclose(out) != 0 || rename(temporary, text) != 0) {
+    fprintf(stderr, "Could not write the file %s.\n", text);
+    exit(EXIT_FAILURE);
+  }
+
+  printf("%zu classes of MacP(%d,%d) from MacP(%d,%d)\n", nr_classes, R, N,
+         N - R, N);
+}
+
+int main(int argc, char *argv[]) {
+  unsigned int nr_threads = std::thread::hardware_concurrency();
+  int i = 1;
+
+  if (i + 1 < argc && strcmp(argv[i], "-j") == 0) {
+    nr_threads = static_cast<unsigned int>(atoi(argv[i + 1]));
+    i += 2;
+  }
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  if (i + 1 < argc && strcmp(argv[i], "--make") == 0)
+    make(argc - i - 1, argv + i + 1, nr_threads);
+  else if (i + 1 < argc && strcmp(argv[i], "--count") == 0)
+    count(argc - i - 1, argv + i + 1, nr_threads);
+  else if (i + 2 == argc && strcmp(argv[i], "--expand") == 0)
+    expand(argv[i + 1], nr_threads);
+  else if (i + 2 == argc && strcmp(argv[i], "--dual") == 0)
+    dual(argv[i + 1], nr_threads);
+  else {
+    printf("Usage: %s [-j threads] --make files...\n"
+           "       %s [-j threads] --count files...\n"
+           "       %s [-j threads] --expand catalog\n"
+           "       %s [-j threads] --dual catalog\n",
+           argv[0], argv[0], argv[0], argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  char text[300];
+  sprintf(text, "class_catalog_rank%d_%delements.json", R, N);
+  statreport(text);
+
+  return 0;
+}
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <atomic>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+#include "classes.h"
+
+static int compareclasses(const ClassEntry &a, const ClassEntry &b) {
+  if (a.nr_bases != b.nr_bases)
+    return a.nr_bases < b.nr_bases ? -1 : 1;
+  return compareOM(a.rep, b.rep);
+}
+
+// the smaller of chi and -chi, as in makeclass()
+static OM normalizesign(const OM &M) {
+  OM X;
+  for (int i = 0; i < nr_ints; i++) {
+    X.plus[i] = M.minus[i];
+    X.minus[i] = M.plus[i];
+  }
+  return compareOM(X, M) < 0 ? X : M;
+}
+
+// Canonicalizing every oriented matroid would cost N! 2^(N-1) steps for each
+// of them. Instead the input is taken in batches of oriented matroids that are
+// not in a class found so far; their canonical forms are found in parallel,
+// and the classes that are new are expanded, so that all their elements in
+// the input are skipped afterwards. This costs two such loops per class.
+std::vector<ClassEntry> makeclasses(std::vector<OM> oms,
+                                    unsigned int nr_threads) {
+  for (OM &M : oms)
+    M = normalizesign(M);
+  std::sort(oms.begin(), oms.end(), lessOM);
+  oms.erase(std::unique(oms.begin(), oms.end(),
+                        [](const OM &a, const OM &b) {
+                          return compareOM(a, b) == 0;
+                        }),
+            oms.end());
+
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  std::vector<ClassEntry> classes;
+  std::vector<char> seen(oms.size(), 0); // in a class found so far
+  size_t first = 0;
+
+  for (;;) {
+    std::vector<size_t> batch;
+    for (; first < oms.size() && batch.size() < 4 * nr_threads; first++)
+      if (!seen[first])
+        batch.push_back(first);
+    if (batch.empty())
+      break;
+
+    std::vector<ClassEntry> found(batch.size());
+    std::vector<std::vector<OM>> members(batch.size());
+    std::atomic<size_t> next{0};
+    auto parallel = [&](auto &&f) {
+      next = 0;
+      std::vector<std::thread> threads;
+      for (unsigned int t = 0; t < nr_threads; t++)
+        threads.emplace_back([&] {
+          for (size_t k = next++; k < batch.size(); k = next++)
+            f(k);
+        });
+      for (auto &t : threads)
+        t.join();
+    };
+
+    parallel([&](size_t k) {
+      ClassEntry &E = found[k];
+      E.rep = canonicalOM(oms[batch[k]], E.stabilizer);
+      E.nr_bases = countbases(E.rep);
+    });
+
+    // the batch can contain several elements of the same class
+    std::vector<size_t> fresh;
+    for (size_t k = 0; k < batch.size(); k++) {
+      size_t j;
+      for (j = 0; j < fresh.size(); j++)
+        if (compareOM(found[fresh[j]].rep, found[k].rep) == 0)
+          break;
+      if (j == fresh.size())
+        fresh.push_back(k);
+    }
+
+    parallel([&](size_t k) {
+      if (std::find(fresh.begin(), fresh.end(), k) != fresh.end())
+        members[k] = makeclass(found[k].rep);
+    });
+
+    for (size_t k : fresh) {
+      classes.push_back(found[k]);
+      for (const OM &M : members[k]) {
+        auto it = std::lower_bound(oms.begin(), oms.end(), M, lessOM);
+        if (it != oms.end() && compareOM(*it, M) == 0)
+          seen[static_cast<size_t>(it - oms.begin())] = 1;
+      }
+    }
+  }
+
+  std::sort(classes.begin(), classes.end(),
+            [](const ClassEntry &a, const ClassEntry &b) {
+              return compareclasses(a, b) < 0;
+            });
+  return classes;
+}
+
+static const char classes_header[] =
+    "Representatives of the permutation/reorientation classes of oriented "
+    "matroids";
+
+void writeclassheader(FILE *out) {
+  fprintf(out,
+          "%s of rank %d on %d elements and the orders of their stabilizers "
+          "in the group of order %lld:\n",
+          classes_header, R, N, classgroupsize);
+}
+
+void writeclass(const ClassEntry &E, FILE *out) {
+  for (int b = 0; b < B; b++)
+    fputc((E.rep.plus[b >> 5] >> (b & 31) & 1)    ? '+'
+          : (E.rep.minus[b >> 5] >> (b & 31) & 1) ? '-'
+                                                  : '0',
+          out);
+  fprintf(out, " %lld\n", E.stabilizer);
+}
+
+int writeclasses(const std::vector<ClassEntry> &classes, FILE *out) {
+  writeclassheader(out);
+  for (const ClassEntry &E : classes)
+    writeclass(E, out);
+  return ferror(out) == 0;
+}
+
+int readclassheader(FILE *in) {
+  char text[400];
+  return fgets(text, sizeof(text), in) != NULL;
+}
+
+int readclass(ClassEntry &E, FILE *in) {
+  char text[400];
+
+  if (fgets(text, sizeof(text), in) == NULL)
+    return 0;
+  if (strspn(text, "+-0") != B || text[B] != ' ')
+    return -1;
+
+  E = ClassEntry();
+  for (int b = 0; b < B; b++) {
+    if (text[b] == '+')
+      E.rep.plus[b >> 5] |= 1u << (b & 31);
+    else if (text[b] == '-')
+      E.rep.minus[b >> 5] |= 1u << (b & 31);
+  }
+  E.stabilizer = atoll(text + B + 1);
+  if (E.stabilizer <= 0 || classgroupsize % E.stabilizer != 0)
+    return -1;
+  E.nr_bases = countbases(E.rep);
+  return 1;
+}
+
+int readclasses(std::vector<ClassEntry> &classes, FILE *in) {
+  if (readclassheader(in) == 0)
+    return 0;
+
+  ClassEntry E;
+  int status;
+  while ((status = readclass(E, in)) == 1)
+    classes.push_back(E);
+
+  return status == 0;
+}
+
+int isclasscatalog(FILE *in) {
+  char text[400];
+  int catalog = fgets(text, sizeof(text), in) != NULL &&
+                strncmp(text, classes_header, strlen(classes_header)) == 0;
+  rewind(in);
+  return catalog;
+}
+
+int readsmaller(OM &M, FILE *in, int uniform) {
+  char text[400];
+
+  while (fgets(text, sizeof(text), in) != NULL) {
+    if (strspn(text, "+-0") != B0 || strchr(" \r\n", text[B0]) == NULL)
+      continue;
+    if (uniform && memchr(text, '0', B0) != NULL) {
+      fprintf(stderr, "The oriented matroid %.*s is not uniform.\n", B0, text);
+      exit(EXIT_FAILURE);
+    }
+    M = OM();
+    for (int i = 0; i < B0; i++)
+      if (text[i] == '+')
+        M.plus[i >> 5] |= 1u << (i & 31);
+      else if (text[i] == '-')
+        M.minus[i >> 5] |= 1u << (i & 31);
+    return 1;
+  }
+
+  return 0;
+}
+
+Expansion startexpansion(const std::vector<ClassEntry> &classes,
+                         unsigned int nr_threads, size_t chunk) {
+  Expansion X;
+  X.classes = &classes;
+  X.nr_threads = nr_threads == 0 ? 1 : nr_threads;
+  X.chunk = chunk == 0 ? 1 : chunk;
+  return X;
+}
+
+// every thread expands its own block of classes, the blocks are then put
+// together in their order
+int nextchunk(Expansion &X, std::vector<OM> &oms) {
+  const std::vector<ClassEntry> &classes = *X.classes;
+  oms.clear();
+  if (X.next >= classes.size())
+    return 0;
+
+  size_t from = X.next;
+  size_t to = std::min(classes.size(), from + X.nr_threads * X.chunk);
+  size_t nr_blocks = (to - from + X.chunk - 1) / X.chunk;
+
+  std::vector<std::vector<OM>> blocks(nr_blocks);
+  std::vector<std::thread> threads;
+  for (size_t k = 0; k < nr_blocks; k++)
+    threads.emplace_back([&, k] {
+      size_t end = std::min(to, from + (k + 1) * X.chunk);
+      for (size_t i = from + k * X.chunk; i < end; i++) {
+        std::vector<OM> members = makeclass(classes[i].rep);
+        blocks[k].insert(blocks[k].end(), members.begin(), members.end());
+      }
+    });
+  for (auto &t : threads)
+    t.join();
+
+  for (const std::vector<OM> &block : blocks)
+    oms.insert(oms.end(), block.begin(), block.end());
+  X.next = to;
+  return 1;
+}
@@ -0,0 +1,132 @@
+#ifndef CLASSES_H
+#define CLASSES_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "OMs.h"
+
+// A catalog of the permutation/reorientation classes of oriented matroids:
+// instead of all elements of every class (as find_all_OMs.c writes them) only
+// the canonical representative (see canonicalOM()) and the order of its
+// stabilizer are stored. The class then has classgroupsize / stabilizer
+// elements, so the numbers of oriented matroids are known without making
+// them, and the classes are expanded with makeclass() when the oriented
+// matroids themselves are needed.
+
+// the number of the permutations and reorientations of makeclass()
+inline constexpr long long classgroupsize =
+    static_cast<long long>(factorial(N)) << (N - 1);
+
+struct ClassEntry {
+  OM rep;               // the canonical representative
+  long long stabilizer; // the order of its stabilizer
+  int nr_bases;
+  int reserved = 0; // keeps the struct free of padding
+};
+
+// the number of oriented matroids in the class
+inline long long classsize(const ClassEntry &E) {
+  return classgroupsize / E.stabilizer;
+}
+
+// the classes of all the given oriented matroids, sorted by the number of
+// bases and then by compareOM(); the canonical forms are found with
+// nr_threads threads
+std::vector<ClassEntry> makeclasses(std::vector<OM> oms,
+                                    unsigned int nr_threads);
+
+// writes the catalog, one line per class with the chirotope of the
+// representative and the order of its stabilizer; returns 0 if writing failed
+int writeclasses(const std::vector<ClassEntry> &classes, FILE *out);
+
+// the same in two steps, for a catalog that is written while the classes are
+// found
+void writeclassheader(FILE *out);
+void writeclass(const ClassEntry &E, FILE *out);
+
+// reads a catalog written by writeclasses(), returns 0 if a line is not a
+// class of MacP(R,N)
+int readclasses(std::vector<ClassEntry> &classes, FILE *in);
+
+// the same one line at a time: readclassheader() skips the header, returns 0
+// for an empty file; readclass() returns 1 for a class, 0 at the end of the
+// file and -1 for a line that is not a class of MacP(R,N)
+int readclassheader(FILE *in);
+int readclass(ClassEntry &E, FILE *in);
+
+// checks whether the file starts with the header of writeclasses(), and goes
+// back to its beginning
+int isclasscatalog(FILE *in);
+
+// The lazy expansion of a catalog: every call of nextchunk() expands the next
+// classes, chunk of them per thread, and returns their elements in the order
+// of the catalog, so only one chunk of oriented matroids is in memory at a
+// time.
+struct Expansion {
+  const std::vector<ClassEntry> *classes;
+  size_t next = 0; // the first class that is not expanded yet
+  size_t nr_threads;
+  size_t chunk;
+};
+
+Expansion startexpansion(const std::vector<ClassEntry> &classes,
+                         unsigned int nr_threads, size_t chunk);
+
+// the elements of the next classes, each stored as the smaller of chi and
+// -chi; returns 0 when all classes are expanded
+int nextchunk(Expansion &X, std::vector<OM> &oms);
+
+// the number of bases on N-1 elements
+inline constexpr int B0 = B * (N - R) / N;
+
+// reads the next oriented matroid on N-1 elements, in a list of oriented
+// matroids or in a catalog of classes, for the programs that extend them by
+// the element N-1; the bit i stands for the i-th basis on N-1 elements (the
+// bases without N-1 in the order of bases[][]). If uniform is set, an
+// oriented matroid that is not uniform is an error. Returns 0 at the end of
+// the file.
+int readsmaller(OM &M, FILE *in, int uniform);
+
+// runs work(k) for k = 0, ..., n-1 on nr_threads threads and calls
+// use(k, result) in the order of k as soon as the result is there, so the
+// output does not depend on the number of threads
+template <typename Work, typename Use>
+void orderedpool(size_t n, unsigned int nr_threads, Work work, Use use) {
+  using Result = decltype(work(size_t()));
+  std::vector<Result> results(n);
+  std::vector<char> done(n, 0);
+  std::mutex m;
+  std::condition_variable ready;
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < (nr_threads == 0 ? 1 : nr_threads); t++)
+    threads.emplace_back([&] {
+      for (size_t k = next++; k < n; k = next++) {
+        Result r = work(k);
+        std::lock_guard<std::mutex> lock(m);
+        results[k] = std::move(r);
+        done[k] = 1;
+        ready.notify_one();
+      }
+    });
+
+  for (size_t k = 0; k < n; k++) {
+    Result r;
+    {
+      std::unique_lock<std::mutex> lock(m);
+      ready.wait(lock, [&] { return done[k] != 0; });
+      r = std::move(results[k]);
+    }
+    use(k, r);
+  }
+
+  for (auto &t : threads)
+    t.join();
+}
+
+#endif // CLASSES_H
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "OMs.h"
+#include "classes.h"
+#include "stats.h"
+
+// This code makes all oriented matroids of rank R on N elements from those on
+// N-1 elements by single-element extensions, instead of the lower cones of
+// Finschi's uniform representatives. Every oriented matroid on N elements
+// with N > R has an element that is not a coloop, and deleting it gives an
+// oriented matroid of rank R on N-1 elements; so it is enough to extend one
+// representative of every class of MacP(R,N-1), e.g. the catalog of
+// class_catalog --make, by the new element p = N-1.
+//
+// An extension keeps the signs of the bases without p and chooses the sign of
+// every basis A+p, where A runs over the (R-1)-subsets of the old elements.
+// These signs are chosen one after the other, and every three-term
+// Grassmann-Pluecker relation is checked as soon as all its bases are known,
+// so that most wrong choices are dropped early; the complete candidates are
+// then checked with ischirotope(). The extensions are deduplicated by their
+// canonical forms (see canonicalOM()).
+//
+// The input is extended by a pool of threads, and the new classes are written
+// to classes_rankR_Nelements.txt (see classes.h) in the order of the input as
+// soon as they are found.
+
+// oldbases[i] is the index in bases of the i-th basis on N-1 elements, the
+// bases A+p are the others; relations[k] are the three-term relations in
+// which newbases[k] is the last basis that is chosen
+struct Tables {
+  std::vector<int> oldbases;
+  std::vector<int> newbases; // in the order in which they are chosen
+  std::vector<std::vector<Relation>> relations;
+};
+
+static Tables maketables() {
+  Tables T;
+  std::vector<int> position(B, -1); // the place in newbases
+
+  for (int b = 0; b < B; b++) {
+    int haslast = 0;
+    for (size_t j = 0; j < R; j++)
+      haslast |= bases[static_cast<size_t>(b), j] == N - 1;
+    if (haslast) {
+      position[static_cast<size_t>(b)] = static_cast<int>(T.newbases.size());
+      T.newbases.push_back(b);
+    } else
+      T.oldbases.push_back(b);
+  }
+
+  T.relations.resize(T.newbases.size());
+  for (const Relation &rel : makerelations()) {
+    int last = -1;
+    for (int t = 0; t < 3; t++)
+      for (int k = 0; k < 2; k++)
+        last = std::max(last, position[static_cast<size_t>(rel.bases[t][k])]);
+    if (last >= 0) // the relations without p hold already
+      T.relations[static_cast<size_t>(last)].push_back(rel);
+  }
+
+  return T;
+}
+
+// the products of a relation are all zero, or there is a positive and a
+// negative one
+static int holds(const Relation &rel, const signed char *chi) {
+  int positive = 0, negative = 0, nonzero = 0;
+  for (int t = 0; t < 3; t++) {
+    int x = rel.sign[t] * chi[rel.bases[t][0]] * chi[rel.bases[t][1]];
+    positive |= x > 0;
+    negative |= x < 0;
+    nonzero |= x != 0;
+  }
+  return !nonzero || (positive && negative);
+}
+
+// chooses the signs of the bases newbases[k], ...
+static void extend(const Tables &T, signed char *chi, size_t k,
+                   std::vector<ClassEntry> &found) {
+  if (k == T.newbases.size()) {
+    OM X;
+    for (int b = 0; b < B; b++)
+      if (chi[b] > 0)
+        X.plus[b >> 5] |= 1u << (b & 31);
+      else if (chi[b] < 0)
+        X.minus[b >> 5] |= 1u << (b & 31);
+    if (ischirotope(X)) {
+      ClassEntry E;
+      E.rep = canonicalOM(X, E.stabilizer);
+      E.nr_bases = countbases(E.rep);
+      found.push_back(E);
+    }
+    return;
+  }
+
+  int b = T.newbases[k];
+  for (int x : {0, 1, -1}) {
+    chi[b] = static_cast<signed char>(x);
+    int good = 1;
+    for (const Relation &rel : T.relations[k])
+      if (!holds(rel, chi)) {
+        good = 0;
+        break;
+      }
+    if (good)
+      extend(T, chi, k + 1, found);
+  }
+  chi[b] = 0;
+}
+
+static int lessclass(const ClassEntry &a, const ClassEntry &b) {
+  return compareOM(a.rep, b.rep) < 0;
+}
+
+// the classes of all extensions of M, sorted by their representatives
+static std::vector<ClassEntry> extensions(const Tables &T, const OM &M) {
+  std::vector<signed char> chi(B, 0);
+  for (int i = 0; i < B0; i++)
+    chi[static_cast<size_t>(T.oldbases[static_cast<size_t>(i)])] =
+        static_cast<signed char>((M.plus[i >> 5] >> (i & 31) & 1)    ? 1
+                                 : (M.minus[i >> 5] >> (i & 31) & 1) ? -1
+                                                                     : 0);
+
+  std::vector<ClassEntry> found;
+  extend(T, chi.data(), 0, found);
+
+  std::sort(found.begin(), found.end(), lessclass);
+  found.erase(std::unique(found.begin(), found.end(),
+                          [](const ClassEntry &a, const ClassEntry &b) {
+                            return compareOM(a.rep, b.rep) == 0;
+                          }),
+              found.end());
+  return found;
+}
+
+int main(int argc, char *argv[]) {
+  unsigned int nr_threads = std::thread::hardware_concurrency();
+  int i = 1;
+
+  if (i + 1 < argc && strcmp(argv[i], "-j") == 0) {
+    nr_threads = static_cast<unsigned int>(atoi(argv[i + 1]));
+    i += 2;
+  }
+  if (i >= argc || N <= R) {
+    printf("Usage: %s [-j threads] files...\n"
+           "The files are lists of oriented matroids of rank %d on %d "
+           "elements or catalogs of their classes.\n",
+           argv[0], R, N - 1);
+    exit(EXIT_FAILURE);
+  }
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  std::vector<OM> input;
+  OM M;
+  for (; i < argc; i++) {
+    FILE *in = fopen(argv[i], "r");
+    if (in == NULL) {
+      fprintf(stderr, "error fopen():  Could not open the file %s.\n",
+              argv[i]);
+      exit(EXIT_FAILURE);
+    }
+    while (readsmaller(M, in, 0))
+      input.push_back(M);
+    fclose(in);
+  }
+
+  Tables T = maketables();
+
+  char text[300];
+  sprintf(text, "classes_rank%d_%delements.txt", R, N);
+  FILE *out = fopen(text, "w");
+  if (out == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", text);
+    exit(EXIT_FAILURE);
+  }
+  writeclassheader(out);
+
+  statbegin("extensions");
+
+  // the classes are written in the order of the input, each the first time
+  // it is found
+  std::set<ClassEntry, decltype(&lessclass)> classes(lessclass);
+  orderedpool(
+      input.size(), nr_threads,
+      [&](size_t k) { return extensions(T, input[k]); },
+      [&](size_t k, const std::vector<ClassEntry> &found) {
+        for (const ClassEntry &E : found)
+          if (classes.insert(E).second)
+            writeclass(E, out);
+        fflush(out);
+        statprogress(k + 1, input.size());
+      });
+
+  statend(input.size());
+
+  fclose(out);
+
+  long long total = 0;
+  for (const ClassEntry &E : classes)
+    total += classsize(E);
+  printf("%zu oriented matroids of rank %d on %d elements extended, %zu "
+         "classes, %lld chirotopes\n",
+         input.size(), R, N - 1, classes.size(), total);
+
+  sprintf(text, "extensions_rank%d_%delements.json", R, N);
+  statreport(text);
+
+  return 0;
+}
@@ -0,0 +1,690 @@
+#include <algorithm>
+#include <bit>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <utility>
+
+#include "groups.h"
+
+static Permutation identity() {
+  Permutation p;
+  for (size_t e = 0; e < N; e++)
+    p[e] = static_cast<unsigned char>(e);
+  return p;
+}
+
+static int isidentity(const Permutation &p) { return p == identity(); }
+
+Permutation compose(const Permutation &p, const Permutation &q) {
+  Permutation r;
+  for (size_t e = 0; e < N; e++)
+    r[e] = q[p[e]];
+  return r;
+}
+
+Permutation inverse(const Permutation &p) {
+  Permutation r;
+  for (size_t e = 0; e < N; e++)
+    r[p[e]] = static_cast<unsigned char>(e);
+  return r;
+}
+
+// divides g by the transversals of the levels from i on, as long as they
+// contain g[base]; returns the level where this stops (base.size() if g is
+// then in none of them)
+static size_t strip(const Group &G, size_t i, Permutation &g) {
+  for (; i < G.base.size(); i++) {
+    int k = G.place[i][g[static_cast<size_t>(G.base[i])]];
+    if (k < 0)
+      return i;
+    g = compose(g, inverse(G.transversal[i][static_cast<size_t>(k)]));
+  }
+  return i;
+}
+
+// makes the orbit of base[i] under the strong generators of the level i and
+// of all levels below it
+static void makeorbit(Group &G, size_t i) {
+  size_t b = static_cast<size_t>(G.base[i]);
+  G.orbit[i].assign(1, G.base[i]);
+  G.place[i].assign(N, -1);
+  G.place[i][b] = 0;
+  G.transversal[i].assign(1, identity());
+
+  for (size_t k = 0; k < G.orbit[i].size(); k++)
+    for (size_t l = i; l < G.base.size(); l++)
+      for (const Permutation &s : G.strong[l]) {
+        size_t y = s[static_cast<size_t>(G.orbit[i][k])];
+        if (G.place[i][y] >= 0)
+          continue;
+        G.place[i][y] = static_cast<int>(G.orbit[i].size());
+        G.orbit[i].push_back(static_cast<int>(y));
+        G.transversal[i].push_back(compose(G.transversal[i][k], s));
+      }
+}
+
+// adds g as a strong generator of the level i, which is made if it is the
+// first level that does not exist yet
+static void addstrong(Group &G, size_t i, const Permutation &g) {
+  if (i == G.base.size()) { // the first element that g moves is the new base
+    int b = 0;
+    while (g[static_cast<size_t>(b)] == b)
+      b++;
+    G.base.push_back(b);
+    G.strong.emplace_back();
+    G.orbit.emplace_back();
+    G.place.emplace_back();
+    G.transversal.emplace_back();
+    makeorbit(G, i);
+  }
+  G.strong[i].push_back(g);
+}
+
+Group makegroup(const std::vector<Permutation> &generators) {
+  Group G;
+  G.generators = generators;
+
+  for (Permutation g : generators) {
+    size_t i = strip(G, 0, g);
+    if (!isidentity(g))
+      addstrong(G, i, g);
+  }
+
+  // every Schreier generator of a level has to be in the levels below it;
+  // the levels are checked from the last one, and after a new strong
+  // generator all of them again
+  int changed = 1;
+  while (changed) {
+    changed = 0;
+    for (size_t i = G.base.size(); i-- > 0 && !changed;) {
+      makeorbit(G, i);
+      for (size_t k = 0; k < G.orbit[i].size() && !changed; k++)
+        for (size_t l = i; l < G.base.size() && !changed; l++)
+          for (size_t j = 0; j < G.strong[l].size() && !changed; j++) {
+            const Permutation &u = G.transversal[i][k];
+            Permutation s = compose(u, G.strong[l][j]);
+            int y = G.place[i][s[static_cast<size_t>(G.base[i])]];
+            Permutation h =
+                compose(s, inverse(G.transversal[i][static_cast<size_t>(y)]));
+            size_t m = strip(G, i + 1, h);
+            if (!isidentity(h)) {
+              addstrong(G, m, h);
+              changed = 1;
+            }
+          }
+    }
+  }
+
+  G.order = 1;
+  for (const auto &o : G.orbit)
+    G.order *= static_cast<long long>(o.size());
+
+  return G;
+}
+
+long long elementnumber(const Group &G, Permutation p) {
+  long long number = 0;
+  for (size_t i = 0; i < G.base.size(); i++) {
+    int k = G.place[i][p[static_cast<size_t>(G.base[i])]];
+    if (k < 0)
+      return -1;
+    number = number * static_cast<long long>(G.orbit[i].size()) + k;
+    p = compose(p, inverse(G.transversal[i][static_cast<size_t>(k)]));
+  }
+
+  return isidentity(p) ? number : -1;
+}
+
+std::vector<Permutation> minimalgenerators(const Group &G) {
+  // first every generator that is not generated by the ones before it
+  std::vector<Permutation> kept;
+  for (const Permutation &g : G.generators)
+    if (elementnumber(makegroup(kept), g) < 0)
+      kept.push_back(g);
+
+  // then the ones that are generated by the later ones are left out
+  for (size_t i = 0; i < kept.size();) {
+    std::vector<Permutation> others = kept;
+    others.erase(others.begin() + static_cast<long>(i));
+    if (elementnumber(makegroup(others), kept[i]) >= 0)
+      kept = others;
+    else
+      i++;
+  }
+
+  return kept;
+}
+
+SignedPermutation compose(const SignedPermutation &g,
+                          const SignedPermutation &h) {
+  SignedPermutation r = {h.reoriented, compose(g.p, h.p)};
+  for (size_t e = 0; e < N; e++)
+    if (g.reoriented >> e & 1)
+      r.reoriented ^= 1u << h.p[e];
+  return r;
+}
+
+OM permute(const OM &M, const SignedPermutation &g) {
+  Permutation p = g.p;
+  return reorient(permute(M, p.data()), g.reoriented);
+}
+
+// the elements of the group generated by the generators, in the order in
+// which they are reached from the identity, at most limit+1 of them
+static std::vector<SignedPermutation>
+listgroup(const std::vector<SignedPermutation> &generators, size_t limit,
+          std::map<SignedPermutation, int> &place) {
+  std::vector<SignedPermutation> elements = {{0, identity()}};
+  place.clear();
+  place.emplace(elements[0], 0);
+
+  for (size_t i = 0; i < elements.size(); i++)
+    for (const SignedPermutation &g : generators) {
+      if (elements.size() > limit)
+        return elements;
+      SignedPermutation h = compose(elements[i], g);
+      if (place.emplace(h, static_cast<int>(elements.size())).second)
+        elements.push_back(h);
+    }
+
+  return elements;
+}
+
+GroupAction makegroupaction(const std::vector<SignedPermutation> &generators,
+                            size_t limit) {
+  GroupAction A;
+  A.elements = listgroup(generators, limit, A.place);
+  if (A.elements.size() > limit)
+    return A;
+
+  // a generator is kept if the ones kept before do not generate it, then
+  // every one is left out that the others generate, as in
+  // minimalgenerators()
+  std::map<SignedPermutation, int> place;
+  for (const SignedPermutation &g : generators) {
+    listgroup(A.generators, limit, place);
+    if (place.count(g) == 0)
+      A.generators.push_back(g);
+  }
+  for (size_t i = 0; i < A.generators.size();) {
+    std::vector<SignedPermutation> others = A.generators;
+    others.erase(others.begin() + static_cast<long>(i));
+    if (listgroup(others, limit, place).size() == A.elements.size())
+      A.generators = others;
+    else
+      i++;
+  }
+
+  return A;
+}
+
+int groupindex(const GroupAction &A, const SignedPermutation &g) {
+  auto it = A.place.find(g);
+  return it == A.place.end() ? -1 : it->second;
+}
+
+int isfixed(const GroupAction &A, const OM &M) {
+  for (const SignedPermutation &g : A.generators)
+    if (isequal(permute(M, g), M) == 0)
+      return 0;
+  return 1;
+}
+
+// the automorphisms: the search below is given the chirotope as signs and
+// the statistics of the pairs of elements
+struct AutSearch {
+  std::vector<signed char> chi;
+  long long pairs[N][N]; // the statistics of (e, f), see automorphisms()
+  int reorientations;
+
+  int image[N];     // the image of the element e, or -1
+  int used[N];      // the element is an image
+  unsigned int mapped;
+  // the equations on the reorientations (bits 0..N-1) and the global sign
+  // (bit N) in echelon form: rows[i] has no bit that is the lowest bit of an
+  // earlier row
+  std::vector<std::pair<unsigned long long, int>> rows;
+};
+
+// the sign of chi on the ordered tuple x
+static int chivalue(const AutSearch &A, std::array<unsigned char, R> x) {
+  auto [y, sign] = sort(x);
+  return sign == 0 ? 0 : sign * A.chi[static_cast<size_t>(ind(y))];
+}
+
+// adds an equation, returns 0 if it contradicts the others
+static int addrow(AutSearch &A, unsigned long long mask, int rhs) {
+  for (const auto &[m, r] : A.rows)
+    if (mask >> std::countr_zero(m) & 1) {
+      mask ^= m;
+      rhs ^= r;
+    }
+  if (mask == 0)
+    return rhs == 0;
+  A.rows.push_back({mask, rhs});
+  return 1;
+}
+
+// maps s to y, returns 0 if a basis of the mapped elements that contains s
+// becomes inconsistent; undomap() takes it back in either case
+static int mapelement(AutSearch &A, int s, int y) {
+  A.image[s] = y;
+  A.used[y] = 1;
+  A.mapped |= 1u << s;
+
+  for (size_t b = 0; b < B; b++) {
+    unsigned int X = 0;
+    std::array<unsigned char, R> x;
+    for (size_t j = 0; j < R; j++) {
+      X |= 1u << bases[b, j];
+      x[j] = static_cast<unsigned char>(A.image[bases[b, j]]);
+    }
+    if ((X >> s & 1) == 0 || (X & ~A.mapped) != 0)
+      continue;
+
+    int v = chivalue(A, x), c = A.chi[b];
+    if ((v == 0) != (c == 0))
+      return 0;
+    if (v == 0)
+      continue;
+
+    // chi(p(X)) chi(X) = e (-1)^{|p(X) & reoriented|}
+    unsigned long long mask = 1ull << N;
+    if (A.reorientations)
+      for (size_t j = 0; j < R; j++)
+        mask |= 1ull << x[j];
+    if (addrow(A, mask, v * c < 0) == 0)
+      return 0;
+  }
+
+  return 1;
+}
+
+static void undomap(AutSearch &A, int s, size_t nr_rows) {
+  A.used[A.image[s]] = 0;
+  A.image[s] = -1;
+  A.mapped &= ~(1u << s);
+  A.rows.resize(nr_rows);
+}
+
+// refines the colors of the elements after individualizing the elements of
+// seq in their order; trace records the refinement, two sequences can only
+// be mapped onto each other if their traces are equal
+static void refine(const AutSearch &A, const std::vector<int> &seq,
+                   std::vector<long long> &color,
+                   std::vector<long long> &trace) {
+  color.assign(N, 0);
+  for (size_t k = 0; k < seq.size(); k++)
+    color[static_cast<size_t>(seq[k])] = static_cast<long long>(k) + 1;
+  trace.clear();
+
+  size_t nr_colors = 0;
+  for (;;) {
+    std::vector<std::vector<long long>> sig(N);
+    for (size_t e = 0; e < N; e++) {
+      for (size_t f = 0; f < N; f++)
+        if (f != e)
+          sig[e].push_back(color[f] << 48 | A.pairs[e][f]);
+      std::sort(sig[e].begin(), sig[e].end());
+      sig[e].push_back(A.pairs[e][e]);
+      sig[e].push_back(color[e]);
+    }
+
+    std::vector<std::vector<long long>> sorted = sig;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    for (size_t e = 0; e < N; e++)
+      color[e] = std::lower_bound(sorted.begin(), sorted.end(), sig[e]) -
+                 sorted.begin();
+    std::sort(sig.begin(), sig.end()); // with the sizes of the classes
+    for (const auto &v : sig)
+      trace.insert(trace.end(), v.begin(), v.end());
+
+    if (sorted.size() == nr_colors)
+      return;
+    nr_colors = sorted.size();
+  }
+}
+
+// extends the map of src to dst to an automorphism, returns 0 if there is
+// none
+static int extend(AutSearch &A, std::vector<int> &src, std::vector<int> &dst) {
+  if (src.size() == N)
+    return 1;
+
+  std::vector<long long> cs, ts, ct, tt;
+  refine(A, src, cs, ts);
+  refine(A, dst, ct, tt);
+  if (ts != tt)
+    return 0;
+
+  // the next element is one of the smallest class that is not mapped
+  int s = -1, best = N + 1;
+  for (int e = 0; e < N; e++) {
+    if (A.image[e] >= 0)
+      continue;
+    int size = static_cast<int>(
+        std::count(cs.begin(), cs.end(), cs[static_cast<size_t>(e)]));
+    if (size < best) {
+      best = size;
+      s = e;
+    }
+  }
+
+  // s itself first, so the first automorphism found from the identity is the
+  // identity
+  std::vector<int> candidates;
+  if (A.used[s] == 0 &&
+      ct[static_cast<size_t>(s)] == cs[static_cast<size_t>(s)])
+    candidates.push_back(s);
+  for (int y = 0; y < N; y++)
+    if (y != s && A.used[y] == 0 &&
+        ct[static_cast<size_t>(y)] == cs[static_cast<size_t>(s)])
+      candidates.push_back(y);
+
+  for (int y : candidates) {
+    size_t nr_rows = A.rows.size();
+    src.push_back(s);
+    dst.push_back(y);
+    if (mapelement(A, s, y) && extend(A, src, dst))
+      return 1;
+    undomap(A, s, nr_rows);
+    src.pop_back();
+    dst.pop_back();
+  }
+
+  return 0;
+}
+
+// the automorphism that is found, with a solution of the equations on the
+// reorientations
+static SignedPermutation found(const AutSearch &A) {
+  SignedPermutation g;
+  for (size_t e = 0; e < N; e++)
+    g.p[e] = static_cast<unsigned char>(A.image[e]);
+
+  unsigned long long value = 0; // the free variables are 0
+  for (size_t i = A.rows.size(); i-- > 0;) {
+    auto [m, r] = A.rows[i];
+    int lowest = std::countr_zero(m);
+    int v = r ^ (std::popcount(m & value) & 1);
+    value |= static_cast<unsigned long long>(v) << lowest;
+  }
+  g.reoriented =
+      static_cast<unsigned int>(value & ((1ull << N) - 1));
+  return g;
+}
+
+// starts a search with nothing mapped
+static void startsearch(AutSearch &A) {
+  for (int e = 0; e < N; e++) {
+    A.image[e] = -1;
+    A.used[e] = 0;
+  }
+  A.mapped = 0;
+  A.rows.clear();
+}
+
+std::vector<SignedPermutation> automorphisms(const OM &M, int reorientations) {
+  AutSearch A;
+  A.reorientations = reorientations;
+  A.chi.resize(B);
+  for (size_t b = 0; b < B; b++)
+    A.chi[b] = static_cast<signed char>(
+        (M.plus[b >> 5] >> (b & 31) & 1) - (M.minus[b >> 5] >> (b & 31) & 1));
+
+  // pairs[e][f]: for how many sets Z of R-1 elements chi(e,Z) chi(f,Z) is
+  // positive and negative (a reorientation of e or f swaps the two), and how
+  // many bases contain e and f; pairs[e][e] is the number of bases that
+  // contain e
+  for (int e = 0; e < N; e++)
+    for (int f = 0; f < N; f++) {
+      long long plus = 0, minus = 0, both = 0;
+      for (size_t b = 0; b < B; b++) {
+        if (A.chi[b] == 0)
+          continue;
+        int contains = 0;
+        for (size_t j = 0; j < R; j++)
+          contains += (bases[b, j] == e) + (bases[b, j] == f);
+        both += contains == 2;
+      }
+      for (size_t b = 0; b < B && e != f; b++) {
+        std::array<unsigned char, R> x, y;
+        int contains_e = 0, contains_f = 0;
+        for (size_t j = 0; j < R; j++) {
+          x[j] = bases[b, j];
+          contains_e |= x[j] == e;
+          contains_f |= x[j] == f;
+        }
+        if (!contains_e || contains_f)
+          continue;
+        y = x;
+        for (size_t j = 0; j < R; j++)
+          if (y[j] == e)
+            y[j] = static_cast<unsigned char>(f);
+        int v = chivalue(A, x) * chivalue(A, y);
+        plus += v > 0;
+        minus += v < 0;
+      }
+      if (reorientations && plus < minus)
+        std::swap(plus, minus);
+      A.pairs[e][f] = plus << 32 | minus << 16 | both;
+    }
+
+  std::vector<SignedPermutation> generators;
+  Permutation id;
+  for (size_t e = 0; e < N; e++)
+    id[e] = static_cast<unsigned char>(e);
+
+  // the reorientations that fix M: the solutions of sum of reoriented[e] over
+  // e in X = e for all bases X, a basis of them from the reduced echelon form
+  if (reorientations) {
+    std::vector<std::pair<unsigned long long, int>> rows; // with the pivots
+    unsigned long long pivots = 0;
+    for (size_t b = 0; b < B; b++) {
+      if (A.chi[b] == 0)
+        continue;
+      unsigned long long m = 1ull << N;
+      for (size_t j = 0; j < R; j++)
+        m |= 1ull << bases[b, j];
+      for (const auto &[r, p] : rows)
+        if (m >> p & 1)
+          m ^= r;
+      if (m == 0)
+        continue;
+      int p = std::countr_zero(m);
+      for (auto &row : rows)
+        if (row.first >> p & 1)
+          row.first ^= m;
+      rows.push_back({m, p});
+      pivots |= 1ull << p;
+    }
+    for (int f = 0; f <= N; f++) {
+      if (pivots >> f & 1)
+        continue;
+      unsigned long long v = 1ull << f;
+      for (const auto &[r, p] : rows)
+        if (r >> f & 1)
+          v |= 1ull << p;
+      unsigned int reoriented =
+          static_cast<unsigned int>(v & ((1ull << N) - 1));
+      if (reoriented)
+        generators.push_back({reoriented, id});
+    }
+  }
+
+  // the base: the order in which the search for the identity maps the
+  // elements
+  std::vector<int> base, dst;
+  startsearch(A);
+  extend(A, base, dst);
+
+  // from the last point of the base to the first: the automorphisms that fix
+  // base[0], ..., base[i-1] and map base[i] to every point of its class that
+  // is not yet in its orbit
+  for (size_t i = base.size(); i-- > 0;) {
+    std::vector<int> prefix(base.begin(), base.begin() + static_cast<long>(i));
+    std::vector<long long> color, trace;
+    refine(A, prefix, color, trace);
+
+    std::vector<int> orbit = {base[i]};
+    std::vector<char> inorbit(N, 0);
+    inorbit[static_cast<size_t>(base[i])] = 1;
+    auto close = [&] {
+      for (size_t k = 0; k < orbit.size(); k++)
+        for (const SignedPermutation &g : generators) {
+          int y = g.p[static_cast<size_t>(orbit[k])];
+          if (!inorbit[static_cast<size_t>(y)]) {
+            inorbit[static_cast<size_t>(y)] = 1;
+            orbit.push_back(y);
+          }
+        }
+    };
+    close(); // the generators found so far fix the prefix
+
+    for (int x = 0; x < N; x++) {
+      if (inorbit[static_cast<size_t>(x)] ||
+          color[static_cast<size_t>(x)] !=
+              color[static_cast<size_t>(base[i])])
+        continue;
+
+      startsearch(A);
+      std::vector<int> src, dst2;
+      int good = 1;
+      for (size_t k = 0; k <= i && good; k++) {
+        int y = k < i ? base[k] : x;
+        src.push_back(base[k]);
+        dst2.push_back(y);
+        good = mapelement(A, base[k], y);
+      }
+      if (good && extend(A, src, dst2)) {
+        generators.push_back(found(A));
+        close();
+      }
+    }
+  }
+
+  return generators;
+}
+
+int readpermutation(const char *text, Permutation &p) {
+  p = identity();
+
+  int used[N] = {};
+  const char *c = text;
+  while (*c) {
+    if (*c != '(')
+      return 0;
+    c++;
+
+    int cycle[N];
+    int len = 0;
+    while (*c && *c != ')') {
+      char *end;
+      long e = strtol(c, &end, 10) - 1;
+      if (end == c || e < 0 || e >= N || used[e] || len == N)
+        return 0;
+      used[e] = 1;
+      cycle[len++] = static_cast<int>(e);
+      c = end;
+      if (*c == ',' || *c == ' ')
+        c++;
+    }
+    if (*c != ')')
+      return 0;
+    c++;
+
+    for (int i = 0; i < len; i++)
+      p[static_cast<size_t>(cycle[i])] =
+          static_cast<unsigned char>(cycle[(i + 1) % len]);
+  }
+
+  return 1;
+}
+
+// the cycle first, first+1, ..., last
+static Permutation cycle(int first, int last) {
+  Permutation p = identity();
+  for (int e = first; e < last; e++)
+    p[static_cast<size_t>(e)] = static_cast<unsigned char>(e + 1);
+  p[static_cast<size_t>(last)] = static_cast<unsigned char>(first);
+  return p;
+}
+
+int readgroup(const char *text, std::vector<SignedPermutation> &generators) {
+  if (text[0] == '(') { // the cycles, then the reoriented elements
+    const char *minus = strchr(text, '-');
+    std::string cycles(text, minus == NULL ? strlen(text)
+                                           : static_cast<size_t>(minus - text));
+    SignedPermutation g = {0, {}};
+    if (readpermutation(cycles.c_str(), g.p) == 0)
+      return 0;
+    for (const char *c = minus; c != NULL && *c;) {
+      char *end;
+      long e = strtol(c + 1, &end, 10) - 1;
+      if (*c != '-' || end == c + 1 || e < 0 || e >= N ||
+          (g.reoriented >> e & 1))
+        return 0;
+      g.reoriented |= 1u << e;
+      c = end;
+    }
+    generators.push_back(g);
+    return 1;
+  }
+
+  int reorientations = strncmp(text, "AutR(", 5) == 0;
+  if (strncmp(text, "Aut(", 4) == 0 || reorientations) {
+    const char *chi = text + (reorientations ? 5 : 4);
+    size_t len = strlen(chi);
+    if (len != B + 1 || strspn(chi, "+-0") != B || chi[B] != ')')
+      return 0;
+    OM M;
+    for (size_t b = 0; b < B; b++) {
+      if (chi[b] == '+')
+        M.plus[b >> 5] |= 1u << (b & 31);
+      else if (chi[b] == '-')
+        M.minus[b >> 5] |= 1u << (b & 31);
+    }
+    for (const SignedPermutation &g : automorphisms(M, reorientations))
+      generators.push_back(g);
+    return 1;
+  }
+
+  int first = 0; // the first element of the block
+  const char *c = text;
+  while (*c) {
+    char family = *c++;
+    char *end;
+    long n = strtol(c, &end, 10);
+    if (end == c || n < 1 || first + n > N || strchr("ZDSA", family) == NULL)
+      return 0;
+    c = end;
+    if (*c == '+')
+      c++;
+    else if (*c)
+      return 0;
+
+    int last = first + static_cast<int>(n) - 1;
+    if (n >= 2 && family != 'A')
+      generators.push_back({0, cycle(first, last)});
+    if (family == 'D' && n >= 3) { // the reflection
+      Permutation p = identity();
+      for (int e = first; e <= last; e++)
+        p[static_cast<size_t>(e)] =
+            static_cast<unsigned char>(first + last - e);
+      generators.push_back({0, p});
+    }
+    if (family == 'S' && n >= 3)
+      generators.push_back({0, cycle(first, first + 1)});
+    if (family == 'A' && n >= 3) { // (1,2,3) and (1,...,n) or (2,...,n)
+      generators.push_back({0, cycle(first, first + 2)});
+      if (n >= 4)
+        generators.push_back({0, cycle(n % 2 ? first : first + 1, last)});
+    }
+
+    first = last + 1;
+  }
+
+  return 1;
+}
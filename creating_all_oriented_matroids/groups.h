@@ -0,0 +1,116 @@
+#ifndef GROUPS_H
+#define GROUPS_H
+
+#include <array>
+#include <map>
+#include <stddef.h>
+#include <vector>
+
+#include "OMs.h"
+
+// Permutation groups on the N elements, used for the group actions on
+// MacP(R,N). A permutation p is stored as the images p[e] of the elements.
+//
+// A group is given by generators and stored by the Schreier-Sims algorithm:
+// base[i] is a point that is fixed by all elements of the i-th level and
+// below, orbit[i] is the orbit of base[i] under them, and transversal[i][x]
+// maps base[i] to x. Every element is then a unique product
+// u_0 u_1 ... u_k of one element u_i of every transversal, which gives the
+// order of the group without listing its elements, a membership test, and a
+// numbering of the elements by the points base[i] is mapped to.
+
+using Permutation = std::array<unsigned char, N>;
+
+struct Group {
+  std::vector<Permutation> generators;
+  std::vector<int> base;
+  std::vector<std::vector<Permutation>> strong; // the generators of each level
+  std::vector<std::vector<int>> orbit;
+  std::vector<std::vector<int>> place; // the place of x in orbit[i], or -1
+  std::vector<std::vector<Permutation>> transversal;
+  long long order;
+};
+
+// p followed by q, i.e. e -> q[p[e]]
+Permutation compose(const Permutation &p, const Permutation &q);
+
+Permutation inverse(const Permutation &p);
+
+// makes the base and the strong generators of the group generated by the
+// given permutations
+Group makegroup(const std::vector<Permutation> &generators);
+
+// the number of the element p in 0, ..., order-1 (the identity is 0), or -1
+// if p is not in the group
+long long elementnumber(const Group &G, Permutation p);
+
+// the generators without those that are generated by the others, in their
+// order
+std::vector<Permutation> minimalgenerators(const Group &G);
+
+// a permutation of the elements followed by the reorientation of the elements
+// in the set reoriented (bit e stands for the element e); reserved makes the
+// size a multiple of 4, so that the struct is not padded
+struct SignedPermutation {
+  unsigned int reoriented;
+  Permutation p;
+  unsigned char reserved[4 - N % 4] = {};
+
+  auto operator<=>(const SignedPermutation &) const = default;
+};
+
+// g followed by h: the reorientation of g is carried along by h.p
+SignedPermutation compose(const SignedPermutation &g,
+                          const SignedPermutation &h);
+
+// reorient(permute(M, g.p), g.reoriented)
+OM permute(const OM &M, const SignedPermutation &g);
+
+// a group of signed permutations acting on MacP(R,N) with all its elements
+// listed, made by makegroupaction() and only read afterwards, so the threads
+// of a search can share it; elements[0] is the identity
+struct GroupAction {
+  std::vector<SignedPermutation> elements;
+  std::map<SignedPermutation, int> place; // the place in elements
+  std::vector<SignedPermutation> generators; // a minimal set of generators
+};
+
+// lists the elements of the group generated by the given signed permutations
+// in the order in which they are reached from the identity by the
+// generators; it stops after limit+1 elements, so elements.size() > limit
+// says that the group is larger than limit
+GroupAction makegroupaction(const std::vector<SignedPermutation> &generators,
+                            size_t limit);
+
+// the i with A.elements[i] = g, or -1 if g is not in the group
+int groupindex(const GroupAction &A, const SignedPermutation &g);
+
+// checks whether M is fixed up to sign under the group, it is enough that the
+// generators fix it
+int isfixed(const GroupAction &A, const OM &M);
+
+// generators of the automorphism group of M: the permutations p with
+// permute(M, p) = +-M, or with reorientations != 0 the signed permutations
+// with reorient(permute(M, p), reoriented) = +-M. The search individualizes
+// one element after another and refines the partitions of the elements by
+// the numbers of bases that contain them and by how often two elements are
+// on the same and on different sides of the hyperplanes spanned by R-1 other
+// elements; a partial map is dropped as soon as it maps a basis to a
+// nonbasis or its signs cannot be made consistent by a reorientation.
+std::vector<SignedPermutation> automorphisms(const OM &M, int reorientations);
+
+// reads a permutation in cycle notation, e.g. "(1,2,3)(4,5)", returns 0 if
+// it is not one
+int readpermutation(const char *text, Permutation &p);
+
+// adds the generators given by text to generators, returns 0 if it is not a
+// group: a permutation in cycle notation, followed by -e for every element e
+// it reorients, e.g. (1,2)(3,4)-5; or the name of a family on the elements
+// 1, ..., n: Zn (cyclic), Dn (dihedral), Sn (symmetric) or An (alternating);
+// names joined by + act on consecutive blocks of elements, e.g. Z3+Z3 is
+// generated by (1,2,3) and (4,5,6); or Aut(chirotope), e.g. Aut(++0-...), the
+// permutations that fix the chirotope up to sign, or AutR(chirotope), the
+// signed permutations that fix it up to sign
+int readgroup(const char *text, std::vector<SignedPermutation> &generators);
+
+#endif // GROUPS_H
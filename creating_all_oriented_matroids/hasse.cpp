@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+#include <thread>
+
+#include "hasse.h"
+
+// Calling weakmap() on all pairs is too slow, so the oriented matroids are
+// grouped by their underlying matroid (the set of bases). M_1 \wm M_2 is only
+// possible if the bases of M_2 are a subset of the bases of M_1, thus for
+// every group we first find all groups with more bases that contain it, and
+// call weakmap() only on the oriented matroids in these groups. The covers of
+// M_2 are then the minimal elements among all M_1 > M_2.
+
+using Support = std::array<unsigned int, nr_ints>;
+
+// the set of bases of M
+static Support support(const OM &M) {
+  Support s;
+  for (size_t i = 0; i < nr_ints; i++)
+    s[i] = M.plus[i] | M.minus[i];
+  return s;
+}
+
+// returns 1 if every basis in a is also in b
+static int issubset(const Support &a, const Support &b) {
+  for (size_t i = 0; i < nr_ints; i++)
+    if ((a[i] & b[i]) != a[i])
+      return 0;
+  return 1;
+}
+
+// the oriented matroids nodes[first], ..., nodes[first + count - 1] have the
+// same bases
+struct SupportGroup {
+  Support bases;
+  int nr_bases;
+  uint32_t first;
+  uint32_t count;
+};
+
+struct Node {
+  OM M;
+  Support bases;
+  int nr_bases;
+};
+
+// finds the covers of all oriented matroids in the groups handed out by next,
+// the edges (lower, upper) are collected in edges
+static void findcovers(const std::vector<OM> &nodes,
+                       const std::vector<SupportGroup> &groups,
+                       std::atomic<size_t> &next,
+                       std::vector<std::pair<uint32_t, uint32_t>> &edges) {
+  std::vector<size_t> above;       // groups that contain the current one
+  std::vector<uint32_t> candidates; // all M_1 > M_2, sorted by bases count
+  std::vector<uint32_t> covers;
+
+  for (size_t g = next++; g < groups.size(); g = next++) {
+    const SupportGroup &G = groups[g];
+
+    above.clear();
+    for (size_t h = g + 1; h < groups.size(); h++)
+      if (groups[h].nr_bases > G.nr_bases && issubset(G.bases, groups[h].bases))
+        above.push_back(h);
+
+    for (uint32_t v = G.first; v < G.first + G.count; v++) {
+      candidates.clear();
+      for (size_t h : above)
+        for (uint32_t u = groups[h].first; u < groups[h].first + groups[h].count;
+             u++)
+          if (weakmap(nodes[u], nodes[v]))
+            candidates.push_back(u);
+
+      // transitive reduction: M_1 covers M_2 iff there is no cover M_3 of M_2
+      // with M_1 > M_3, the candidates are sorted by the number of bases, so
+      // all possible M_3 have already been found
+      covers.clear();
+      for (uint32_t u : candidates) {
+        size_t c;
+        for (c = 0; c < covers.size(); c++)
+          if (weakmap(nodes[u], nodes[covers[c]]))
+            break;
+        if (c == covers.size())
+          covers.push_back(u);
+      }
+
+      for (uint32_t u : covers)
+        edges.push_back({v, u});
+    }
+  }
+}
+
+HasseDiagram makehasse(std::vector<OM> oms, unsigned int nr_threads) {
+  std::vector<Node> list;
+
+  list.reserve(oms.size());
+  for (const OM &M : oms)
+    list.push_back({M, support(M), countbases(M)});
+  oms.clear();
+  oms.shrink_to_fit();
+
+  // sorts by the number of bases and then by the bases themselves, so that
+  // every group of oriented matroids with the same bases is contiguous
+  std::stable_sort(list.begin(), list.end(), [](const Node &a, const Node &b) {
+    if (a.nr_bases != b.nr_bases)
+      return a.nr_bases < b.nr_bases;
+    return a.bases < b.bases;
+  });
+
+  HasseDiagram H;
+  std::vector<SupportGroup> groups;
+
+  H.nodes.reserve(list.size());
+  for (uint32_t i = 0; i < list.size(); i++) {
+    H.nodes.push_back(list[i].M);
+    if (groups.empty() || groups.back().bases != list[i].bases)
+      groups.push_back({list[i].bases, list[i].nr_bases, i, 0});
+    groups.back().count++;
+  }
+  list.clear();
+  list.shrink_to_fit();
+
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  std::atomic<size_t> next{0};
+  std::vector<std::vector<std::pair<uint32_t, uint32_t>>> edges(nr_threads);
+  std::vector<std::thread> threads;
+
+  for (unsigned int t = 0; t < nr_threads; t++)
+    threads.emplace_back(findcovers, std::cref(H.nodes), std::cref(groups),
+                         std::ref(next), std::ref(edges[t]));
+  for (auto &t : threads)
+    t.join();
+
+  // stores the edges in compressed sparse row form
+  H.offsets.assign(H.nodes.size() + 1, 0);
+  for (const auto &e : edges)
+    for (const auto &[v, u] : e)
+      H.offsets[v + 1]++;
+  for (size_t i = 0; i < H.nodes.size(); i++)
+    H.offsets[i + 1] += H.offsets[i];
+
+  H.targets.resize(H.offsets.back());
+  std::vector<uint64_t> fill(H.offsets.begin(), H.offsets.end() - 1);
+  for (auto &e : edges) {
+    for (const auto &[v, u] : e)
+      H.targets[fill[v]++] = u;
+    e.clear();
+    e.shrink_to_fit();
+  }
+  for (size_t i = 0; i < H.nodes.size(); i++) // deterministic output
+    std::sort(H.targets.begin() + static_cast<ptrdiff_t>(H.offsets[i]),
+              H.targets.begin() + static_cast<ptrdiff_t>(H.offsets[i + 1]));
+
+  return H;
+}
+
+int readcatalogs(std::vector<OM> &oms, int nr_files, char *files[]) {
+  OM M;
+
+  for (int f = 0; f < nr_files; f++) {
+    FILE *in = fopen(files[f], "r");
+    if (in == NULL) {
+      fprintf(stderr, "error fopen():  Could not open text file %s.\n",
+              files[f]);
+      return 0;
+    }
+    while (readOM(&M, in) != 0)
+      oms.push_back(M);
+    fclose(in);
+  }
+
+  if (oms.size() >= UINT32_MAX) {
+    fprintf(stderr, "Too many oriented matroids.\n");
+    return 0;
+  }
+
+  return 1;
+}
+
+static const char hasse_magic[8] = {'M', 'A', 'C', 'P', 'C', 'S', 'R', '1'};
+
+int writehasse(const HasseDiagram &H, FILE *out) {
+  HasseHeader h;
+  memcpy(h.magic, hasse_magic, sizeof(h.magic));
+  h.rank = R;
+  h.elements = N;
+  h.ints = nr_ints;
+  h.reserved = 0;
+  h.nr_nodes = H.nodes.size();
+  h.nr_edges = H.targets.size();
+
+  if (fwrite(&h, sizeof(h), 1, out) != 1)
+    return 0;
+
+  for (const OM &M : H.nodes)
+    if (fwrite(M.plus, sizeof(M.plus), 1, out) != 1 ||
+        fwrite(M.minus, sizeof(M.minus), 1, out) != 1)
+      return 0;
+
+  if (fwrite(H.offsets.data(), sizeof(uint64_t), H.offsets.size(), out) !=
+      H.offsets.size())
+    return 0;
+  if (fwrite(H.targets.data(), sizeof(uint32_t), H.targets.size(), out) !=
+      H.targets.size())
+    return 0;
+
+  return 1;
+}
+
+int readhasse(HasseDiagram &H, FILE *in) {
+  HasseHeader h;
+
+  if (fread(&h, sizeof(h), 1, in) != 1)
+    return 0;
+  if (memcmp(h.magic, hasse_magic, sizeof(h.magic)) != 0 || h.rank != R ||
+      h.elements != N || h.ints != nr_ints) {
+    fprintf(stderr, "The diagram was not made for MacP(%d,%d).\n", R, N);
+    return 0;
+  }
+
+  H.nodes.resize(h.nr_nodes);
+  for (OM &M : H.nodes)
+    if (fread(M.plus, sizeof(M.plus), 1, in) != 1 ||
+        fread(M.minus, sizeof(M.minus), 1, in) != 1)
+      return 0;
+
+  H.offsets.resize(h.nr_nodes + 1);
+  H.targets.resize(h.nr_edges);
+  if (fread(H.offsets.data(), sizeof(uint64_t), H.offsets.size(), in) !=
+      H.offsets.size())
+    return 0;
+  if (fread(H.targets.data(), sizeof(uint32_t), H.targets.size(), in) !=
+      H.targets.size())
+    return 0;
+
+  return H.offsets.back() == h.nr_edges;
+}
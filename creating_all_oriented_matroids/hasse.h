@@ -0,0 +1,48 @@
+#ifndef HASSE_H
+#define HASSE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#include "OMs.h"
+
+// The Hasse diagram of the weak map order on MacP(R,N), stored in compressed
+// sparse row form: the oriented matroids covering nodes[i] are
+// nodes[targets[offsets[i]]], ..., nodes[targets[offsets[i + 1] - 1]].
+// The nodes are sorted by the number of bases, so every edge goes from a
+// smaller to a larger index.
+struct HasseDiagram {
+  std::vector<OM> nodes;
+  std::vector<uint64_t> offsets; // nodes.size() + 1 entries
+  std::vector<uint32_t> targets; // one entry per cover relation
+};
+
+// the header of a .csr file, followed by the nodes (plus, then minus of every
+// OM), the offsets and the targets
+struct HasseHeader {
+  char magic[8]; // "MACPCSR1"
+  uint32_t rank;
+  uint32_t elements;
+  uint32_t ints; // nr_ints of the program that wrote the file
+  uint32_t reserved;
+  uint64_t nr_nodes;
+  uint64_t nr_edges;
+};
+
+// constructs the Hasse diagram of the weak map order on the given oriented
+// matroids (the whole MacP(R,N) if oms is the whole catalog) using nr_threads
+// threads
+HasseDiagram makehasse(std::vector<OM> oms, unsigned int nr_threads);
+
+// reads all oriented matroids from the catalog files, returns 0 if a file
+// could not be opened
+int readcatalogs(std::vector<OM> &oms, int nr_files, char *files[]);
+
+// writes the diagram, returns 0 if writing failed
+int writehasse(const HasseDiagram &H, FILE *out);
+
+// reads a diagram written for the same R and N, returns 0 on failure
+int readhasse(HasseDiagram &H, FILE *in);
+
+#endif // HASSE_H
@@ -1,17 +1,29 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #include "OMs.h"
+#include "checkpoint.h"
+#include "stats.h"
 
 // This code takes all uniform oriented matroids that are representatives of
 // reorientation and permutation classes, as found by Finschi, and constructs
 // their lower cones.
+//
+// The run can take days, so every checkpoint_interval seconds (and when the
+// program gets SIGTERM) the number of checked subsets, the number of found
+// chirotopes and the size of the output are written to a checkpoint file.
+// With --resume the output is cut back to that size and the enumeration
+// continues from there.
+
+// seconds between two checkpoints
+static const time_t checkpoint_interval = 600;
 
 // makes the lower cone of a uniform OM M, works only for OMs with at most 64
 // bases -- it would be too slow otherwise, anyway
-static int makechirotopes(struct OM &M, FILE *out) {
-  int c = 0;
+static long long makechirotopes(struct OM &M, FILE *out, Checkpoint &C,
+                                const char *checkpoint) {
   long long int i, j;
   long long int limit1, limit2;
 
@@ -25,57 +37,109 @@ static int makechirotopes(struct OM &M, FILE *out) {
     return -1;
 
   OM X;
+  time_t last = time(NULL);
+  auto first = static_cast<unsigned long long>(C.counter);
+
+  statbegin("lower cone");
 
-  for (i = 0; i < limit1;
+  for (i = static_cast<long long int>(C.counter); i < limit1;
        i++) // checks for every subset of the bases of M whether it gives an OM
   {
-    X.plus[0] = M.plus[0] & i;
-    X.minus[0] = M.minus[0] & i;
+    if (stop_requested ||
+        ((i & 0xfffff) == 0 && time(NULL) - last >= checkpoint_interval)) {
+      C.counter = static_cast<unsigned long long>(i);
+      C.offset = outputoffset(out);
+      if (writecheckpoint(checkpoint, C) == 0)
+        fprintf(stderr, "Could not write the checkpoint %s.\n", checkpoint);
+      if (stop_requested) {
+        printf("Stopped after %lld subsets, %lld chirotopes so far.\n", i,
+               C.count);
+        fclose(out);
+        exit(EXIT_SUCCESS);
+      }
+      last = time(NULL);
+    }
+
+    if ((i & 0xffff) == 0)
+      statprogress(static_cast<unsigned long long>(i) - first,
+                   static_cast<unsigned long long>(limit1) - first);
+
+    X.plus[0] = M.plus[0] & static_cast<unsigned int>(i);
+    X.minus[0] = M.minus[0] & static_cast<unsigned int>(i);
 
     for (j = 0; j < limit2; j++) {
       if (B > 32) {
-        X.plus[1] = M.plus[1] & j;
-        X.minus[1] = M.minus[1] & j;
+        X.plus[1] = M.plus[1] & static_cast<unsigned int>(j);
+        X.minus[1] = M.minus[1] & static_cast<unsigned int>(j);
       }
       if (ischirotope(X)) {
         writeOM(X, out);
-        c++;
+        C.count++;
       }
     }
   }
 
-  return c;
+  statend((static_cast<unsigned long long>(limit1) - first) *
+          static_cast<unsigned long long>(limit2));
+
+  return C.count;
 }
 
 int main(int argc, char *argv[]) {
-  if (argc != 2) {
-    printf("An argument expected.\n");
+  int resume = argc == 3 && strcmp(argv[1], "--resume") == 0;
+
+  if (argc != 2 + resume) {
+    printf("Usage: %s [--resume] step\n", argv[0]);
     exit(EXIT_FAILURE);
   }
 
   char *ptr;
-  auto step = strtol(argv[1], &ptr, 10); // gets the number of a lower cone
+  auto step = strtol(argv[1 + resume], &ptr,
+                     10); // gets the number of a lower cone
   makebases();
 
   FILE *in, *out;
   char text[300];
+  char checkpoint[300];
   OM M;
   int i = 0;
-  int c;
+  long long c;
+  Checkpoint C;
+
+  sprintf(checkpoint, "lower_cones_rank%d_%delements_%ld.checkpoint", R, N,
+          step);
+  if (resume && readcheckpoint(checkpoint, C) == 0) {
+    printf("No checkpoint %s found, starting from the beginning.\n",
+           checkpoint);
+    resume = 0;
+  }
 
   sprintf(text, "lower_cones_rank%d_%delements_%ld.txt", R, N,
           step); // the output - all elements in the lower cone of the step-th
                  // uniform OM
 
-  out = fopen(text, "w");
+  out = fopen(text, resume ? "r+" : "w");
   if (out == NULL) {
     fprintf(stderr, "error fopen():  Could not open text file %s.\n", text);
     exit(EXIT_FAILURE);
   }
-  fprintf(out,
-          "Elements of lower cone of the %ld-th uniform representative (under "
-          "reorientations and permutations) of rank %d on %d elements:\n",
-          step, R, N);
+
+  if (resume) // everything written after the checkpoint is made again
+  {
+    if (truncateoutput(out, C.offset) == 0) {
+      fprintf(stderr, "Could not truncate the file %s.\n", text);
+      exit(EXIT_FAILURE);
+    }
+    printf("Resuming after %llu subsets and %lld chirotopes.\n", C.counter,
+           C.count);
+  } else
+    fprintf(out,
+            "Elements of lower cone of the %ld-th uniform representative "
+            "(under reorientations and permutations) of rank %d on %d "
+            "elements:\n",
+            step, R, N);
+
+  installstophandler();
 
   if (R >= 3) {
     sprintf(text, "uniform_representatives_rank%d_%delements.txt", R, N);
@@ -96,8 +160,8 @@ int main(int argc, char *argv[]) {
 
     if (readOM(&M, in) != 0) // we work only with the step-th OM
     {
-      c = makechirotopes(M, out);
-      printf("%d chirotopes\n", c);
+      c = makechirotopes(M, out, C, checkpoint);
+      printf("%lld chirotopes\n", c);
     } else
       printf("Mistake - the input argument is too large.\n");
 
@@ -114,11 +178,15 @@ int main(int argc, char *argv[]) {
 
     showchirotope(M);
 
-    c = makechirotopes(M, out);
-    printf("%d chirotopes\n", c);
+    c = makechirotopes(M, out, C, checkpoint);
+    printf("%lld chirotopes\n", c);
   }
 
   fclose(out);
+  remove(checkpoint); // the lower cone is complete
+
+  sprintf(text, "lower_cones_rank%d_%delements_%ld.json", R, N, step);
+  statreport(text);
 
   return 0;
 }
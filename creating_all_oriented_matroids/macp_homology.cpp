@@ -0,0 +1,491 @@
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "OMs.h"
+#include "hasse.h"
+#include "stats.h"
+
+// This code computes the homology of the order complex of MacP(R,N) over Z/p.
+// The poset is given either by the catalog files (then its Hasse diagram is
+// constructed as in weakmap_hasse) or by a .csr file written by weakmap_hasse.
+//
+// First the poset is replaced by its core: an element with exactly one lower
+// (or upper) cover is a beat point and removing it does not change the
+// homotopy type of the order complex. Then the chain groups of the order
+// complex of the core are generated one dimension at a time, from the top
+// dimension down, and the ranks of the boundary matrices are computed by
+// column reduction. A column of d is skipped if its simplex is the pivot of a
+// reduced column of d+1 (clearing), so only two chain groups are kept in
+// memory at the same time.
+
+// the prime p, the coefficients are stored as numbers 0,...,p-1
+static uint32_t p = 2;
+
+static uint32_t mulmod(uint32_t a, uint32_t b) {
+  return static_cast<uint32_t>(static_cast<uint64_t>(a) * b % p);
+}
+
+static uint32_t inverse(uint32_t a) // a^(p-2) is the inverse of a in Z/p
+{
+  uint32_t r = 1;
+  for (uint32_t e = p - 2; e; e >>= 1) {
+    if (e & 1)
+      r = mulmod(r, a);
+    a = mulmod(a, a);
+  }
+  return r;
+}
+
+static int isprime(uint32_t n) {
+  if (n < 2)
+    return 0;
+  for (uint32_t d = 2; d <= n / d; d++)
+    if (n % d == 0)
+      return 0;
+  return 1;
+}
+
+// the poset, stored by its upper and lower covers
+struct Poset {
+  std::vector<std::vector<uint32_t>> up;
+  std::vector<std::vector<uint32_t>> down;
+  std::vector<int> nr_bases;
+  std::vector<char> removed;
+};
+
+static void erase(std::vector<uint32_t> &v, uint32_t x) {
+  v.erase(std::find(v.begin(), v.end(), x));
+}
+
+// returns 1 if there is an element between y and z, the bases counts grow
+// along the covers, so we only need to look at elements with less bases than z
+static int between(const Poset &P, uint32_t y, uint32_t z,
+                   std::vector<uint32_t> &stamp, uint32_t s,
+                   std::vector<uint32_t> &stack) {
+  stack.clear();
+  for (uint32_t w : P.up[y])
+    if (w != z && P.nr_bases[w] < P.nr_bases[z]) {
+      stamp[w] = s;
+      stack.push_back(w);
+    }
+
+  while (!stack.empty()) {
+    uint32_t w = stack.back();
+    stack.pop_back();
+    for (uint32_t u : P.up[w]) {
+      if (u == z)
+        return 1;
+      if (P.nr_bases[u] < P.nr_bases[z] && stamp[u] != s) {
+        stamp[u] = s;
+        stack.push_back(u);
+      }
+    }
+  }
+
+  return 0;
+}
+
+// removes beat points as long as there are some, returns the number of
+// remaining elements
+static size_t makecore(Poset &P) {
+  size_t n = P.up.size();
+  size_t alive = n;
+  std::vector<uint32_t> queue;
+  std::vector<uint32_t> stamp(n, 0);
+  std::vector<uint32_t> stack;
+  uint32_t s = 0;
+
+  for (uint32_t x = 0; x < n; x++)
+    queue.push_back(x);
+
+  while (!queue.empty()) {
+    uint32_t x = queue.back();
+    queue.pop_back();
+    if (P.removed[x] || (P.down[x].size() != 1 && P.up[x].size() != 1))
+      continue;
+
+    P.removed[x] = 1;
+    alive--;
+
+    std::vector<uint32_t> lower = std::move(P.down[x]);
+    std::vector<uint32_t> upper = std::move(P.up[x]);
+    P.down[x].clear();
+    P.up[x].clear();
+
+    for (uint32_t y : lower)
+      erase(P.up[y], x);
+    for (uint32_t z : upper)
+      erase(P.down[z], x);
+
+    // y < x < z, so y < z remains true and it is a cover if there is nothing
+    // else in between
+    for (uint32_t y : lower)
+      for (uint32_t z : upper)
+        if (between(P, y, z, stamp, ++s, stack) == 0) {
+          P.up[y].push_back(z);
+          P.down[z].push_back(y);
+        }
+
+    for (uint32_t y : lower)
+      queue.push_back(y);
+    for (uint32_t z : upper)
+      queue.push_back(z);
+  }
+
+  return alive;
+}
+
+// the strict upper sets of all elements of the core (renumbered 0,...,n-1),
+// stored in compressed sparse row form and sorted
+struct Comparabilities {
+  std::vector<uint64_t> offsets;
+  std::vector<uint32_t> above;
+  uint32_t n;
+  int height; // the number of elements of the longest chain
+};
+
+static Comparabilities makecomparabilities(const Poset &P) {
+  size_t n = P.up.size();
+  std::vector<uint32_t> index(n, UINT32_MAX);
+  uint32_t m = 0;
+
+  for (uint32_t x = 0; x < n; x++) // elements are sorted by bases count
+    if (!P.removed[x])
+      index[x] = m++;
+
+  // the upper sets are made from the top, U(x) is the union of U(z) and z for
+  // all covers z of x
+  std::vector<std::vector<uint32_t>> U(m);
+  std::vector<int> height(m, 1);
+  int maxheight = 0;
+
+  for (size_t x = n; x-- > 0;) {
+    if (P.removed[x])
+      continue;
+    auto &u = U[index[x]];
+    for (uint32_t z : P.up[x]) {
+      u.push_back(index[z]);
+      u.insert(u.end(), U[index[z]].begin(), U[index[z]].end());
+      height[index[x]] = std::max(height[index[x]], height[index[z]] + 1);
+    }
+    std::sort(u.begin(), u.end());
+    u.erase(std::unique(u.begin(), u.end()), u.end());
+    maxheight = std::max(maxheight, height[index[x]]);
+  }
+
+  Comparabilities C;
+  C.n = m;
+  C.height = maxheight;
+  C.offsets.assign(m + 1, 0);
+  for (size_t x = 0; x < m; x++)
+    C.offsets[x + 1] = C.offsets[x] + U[x].size();
+  C.above.reserve(C.offsets[m]);
+  for (auto &u : U) {
+    C.above.insert(C.above.end(), u.begin(), u.end());
+    u.clear();
+    u.shrink_to_fit();
+  }
+
+  return C;
+}
+
+// the d-simplices of the order complex (chains x_0 < ... < x_d), sorted
+// lexicographically and stored one after the other
+struct ChainGroup {
+  size_t len; // d + 1, the number of elements of a chain
+  size_t size;
+  std::vector<uint32_t> chains;
+
+  const uint32_t *operator[](size_t i) const { return chains.data() + i * len; }
+};
+
+static void extendchains(const Comparabilities &C, std::vector<uint32_t> &chain,
+                         int d, std::vector<uint32_t> &out) {
+  if (static_cast<int>(chain.size()) == d + 1) {
+    out.insert(out.end(), chain.begin(), chain.end());
+    return;
+  }
+
+  uint32_t x = chain.back();
+  for (uint64_t i = C.offsets[x]; i < C.offsets[x + 1]; i++) {
+    chain.push_back(C.above[i]);
+    extendchains(C, chain, d, out);
+    chain.pop_back();
+  }
+}
+
+// makes all d-simplices, the elements x_0 are split into blocks for the
+// threads, so the result is sorted
+static ChainGroup makechains(const Comparabilities &C, int d,
+                             unsigned int nr_threads) {
+  std::vector<std::vector<uint32_t>> parts(nr_threads);
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < nr_threads; t++)
+    threads.emplace_back([&, t] {
+      std::vector<uint32_t> chain;
+      for (size_t x = C.n * t / nr_threads; x < C.n * (t + 1) / nr_threads;
+           x++) {
+        chain.assign(1, static_cast<uint32_t>(x));
+        extendchains(C, chain, d, parts[t]);
+      }
+    });
+  for (auto &t : threads)
+    t.join();
+
+  ChainGroup G;
+  G.len = static_cast<size_t>(d + 1);
+  for (auto &part : parts) {
+    G.chains.insert(G.chains.end(), part.begin(), part.end());
+    part.clear();
+    part.shrink_to_fit();
+  }
+  G.size = G.chains.size() / G.len;
+
+  return G;
+}
+
+// returns the index of the chain a (of length G.len) in G
+static size_t findchain(const ChainGroup &G, const uint32_t *a) {
+  size_t l = 0, u = G.size;
+
+  while (l < u) {
+    size_t m = (l + u) / 2;
+    const uint32_t *b = G[m];
+    if (std::lexicographical_compare(b, b + G.len, a, a + G.len))
+      l = m + 1;
+    else
+      u = m;
+  }
+  return l;
+}
+
+// a sparse column, (row, coefficient) sorted by rows
+using Column = std::vector<std::pair<size_t, uint32_t>>;
+
+static void boundary(const ChainGroup &C, const ChainGroup &F, size_t j,
+                     Column &col, std::vector<uint32_t> &face) {
+  const uint32_t *chain = C[j];
+  col.clear();
+
+  for (size_t i = 0; i < C.len; i++) // drops x_i with the sign (-1)^i
+  {
+    face.clear();
+    for (size_t k = 0; k < C.len; k++)
+      if (k != i)
+        face.push_back(chain[k]);
+    col.push_back({findchain(F, face.data()), (i & 1) ? p - 1 : 1});
+  }
+  std::sort(col.begin(), col.end());
+}
+
+// col -= f * r, where r is a reduced column
+static void subtract(Column &col, uint32_t f, const Column &r, Column &tmp) {
+  tmp.clear();
+  size_t a = 0, b = 0;
+  uint32_t g = p - f;
+
+  while (a < col.size() || b < r.size()) {
+    if (b == r.size() || (a < col.size() && col[a].first < r[b].first))
+      tmp.push_back(col[a++]);
+    else if (a == col.size() || r[b].first < col[a].first) {
+      tmp.push_back({r[b].first, mulmod(g, r[b].second)});
+      b++;
+    } else {
+      uint32_t c = (col[a].second + mulmod(g, r[b].second)) % p;
+      if (c)
+        tmp.push_back({col[a].first, c});
+      a++;
+      b++;
+    }
+  }
+  col.swap(tmp);
+}
+
+// reduces col by the already reduced columns (stored with leading
+// coefficient 1) until its pivot is new
+static void reduce(Column &col, const std::vector<int64_t> &pivot,
+                   const std::vector<Column> &reduced, Column &tmp) {
+  while (!col.empty()) {
+    int64_t r = pivot[col.back().first];
+    if (r < 0)
+      return;
+    subtract(col, col.back().second, reduced[static_cast<size_t>(r)], tmp);
+  }
+}
+
+// computes the rank of the boundary map from C to F, the columns marked in
+// cleared are skipped, and the pivots (simplices of F that are boundaries) are
+// marked in newcleared
+static size_t rank(const ChainGroup &C, const ChainGroup &F,
+                   const std::vector<char> &cleared,
+                   std::vector<char> &newcleared, unsigned int nr_threads) {
+  const size_t chunk = 1 << 14;
+  std::vector<int64_t> pivot(F.size, -1);
+  std::vector<Column> reduced;
+  std::vector<Column> work(chunk);
+  Column tmp;
+
+  newcleared.assign(F.size, 0);
+
+  for (size_t first = 0; first < C.size; first += chunk) {
+    size_t last = std::min(C.size, first + chunk);
+
+    // the columns of a chunk are reduced in parallel by the columns of the
+    // previous chunks ...
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nr_threads; t++)
+      threads.emplace_back([&, t] {
+        Column tmp;
+        std::vector<uint32_t> face;
+        for (size_t j = first + t; j < last; j += nr_threads) {
+          if (!cleared.empty() && cleared[j]) {
+            work[j - first].clear();
+            continue;
+          }
+          boundary(C, F, j, work[j - first], face);
+          reduce(work[j - first], pivot, reduced, tmp);
+        }
+      });
+    for (auto &t : threads)
+      t.join();
+
+    // ... and then by each other
+    for (size_t j = first; j < last; j++) {
+      Column &col = work[j - first];
+      reduce(col, pivot, reduced, tmp);
+      if (col.empty())
+        continue;
+
+      uint32_t f = inverse(col.back().second);
+      for (auto &[row, c] : col)
+        c = mulmod(c, f);
+      pivot[col.back().first] = static_cast<int64_t>(reduced.size());
+      newcleared[col.back().first] = 1;
+      reduced.push_back(std::move(col));
+      col = Column();
+    }
+  }
+
+  return reduced.size();
+}
+
+int main(int argc, char *argv[]) {
+  unsigned int nr_threads = std::thread::hardware_concurrency();
+  int i = 1;
+
+  while (i + 1 < argc && argv[i][0] == '-') {
+    if (strcmp(argv[i], "-p") == 0) {
+      int q = atoi(argv[i + 1]);
+      p = q < 0 ? 0 : static_cast<uint32_t>(q);
+    } else if (strcmp(argv[i], "-j") == 0)
+      nr_threads = static_cast<unsigned int>(atoi(argv[i + 1]));
+    else
+      break;
+    i += 2;
+  }
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  if (i >= argc || !isprime(p)) { // inverse() needs a prime
+    printf("Usage: %s [-p prime] [-j threads] (hasse.csr | catalog files...)\n",
+           argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  HasseDiagram H;
+  size_t len = strlen(argv[i]);
+  if (len > 4 && strcmp(argv[i] + len - 4, ".csr") == 0) {
+    FILE *in = fopen(argv[i], "rb");
+    if (in == NULL) {
+      fprintf(stderr, "error fopen():  Could not open the file %s.\n", argv[i]);
+      exit(EXIT_FAILURE);
+    }
+    if (readhasse(H, in) == 0) {
+      fprintf(stderr, "Could not read the file %s.\n", argv[i]);
+      exit(EXIT_FAILURE);
+    }
+    fclose(in);
+  } else {
+    std::vector<OM> oms;
+    if (readcatalogs(oms, argc - i, argv + i) == 0)
+      exit(EXIT_FAILURE);
+    H = makehasse(std::move(oms), nr_threads);
+  }
+  if (H.nodes.empty()) {
+    fprintf(stderr, "No oriented matroids of rank %d on %d elements found.\n",
+            R, N);
+    exit(EXIT_FAILURE);
+  }
+
+  Poset P;
+  size_t n = H.nodes.size();
+  P.up.resize(n);
+  P.down.resize(n);
+  P.removed.assign(n, 0);
+  for (size_t x = 0; x < n; x++) {
+    P.nr_bases.push_back(countbases(H.nodes[x]));
+    for (uint64_t e = H.offsets[x]; e < H.offsets[x + 1]; e++) {
+      P.up[x].push_back(H.targets[e]);
+      P.down[H.targets[e]].push_back(static_cast<uint32_t>(x));
+    }
+  }
+  H = HasseDiagram();
+
+  statbegin("core");
+  size_t core = makecore(P);
+  statend(n);
+  printf("%zu oriented matroids, %zu in the core\n", n, core);
+
+  Comparabilities C = makecomparabilities(P);
+  P = Poset();
+  printf("%zu comparable pairs, the longest chain has %d elements\n",
+         C.above.size(), C.height);
+
+  int top = C.height - 1;
+  std::vector<size_t> betti(static_cast<size_t>(top + 1), 0);
+  std::vector<char> cleared, newcleared;
+  size_t rank_above = 0;
+
+  ChainGroup current = makechains(C, top, nr_threads);
+
+  for (int d = top; d >= 0; d--) {
+    size_t rank_d = 0;
+
+    if (d > 0) {
+      ChainGroup faces = makechains(C, d - 1, nr_threads);
+      char phase[100];
+      sprintf(phase, "reduction in dimension %d", d);
+      statbegin(phase);
+      rank_d = rank(current, faces, cleared, newcleared, nr_threads);
+      statend(current.size);
+      betti[static_cast<size_t>(d)] = current.size - rank_d - rank_above;
+      printf("dimension %d: %zu simplices, rank of the boundary %zu\n", d,
+             current.size, rank_d);
+      current = std::move(faces);
+      cleared.swap(newcleared);
+    } else {
+      betti[0] = current.size - rank_above;
+      printf("dimension 0: %zu simplices\n", current.size);
+    }
+
+    rank_above = rank_d;
+  }
+
+  printf("Betti numbers of MacP(%d,%d) over Z/%u:", R, N, p);
+  for (size_t b : betti)
+    printf(" %zu", b);
+  putchar('\n');
+
+  char text[300];
+  sprintf(text, "homology_rank%d_%delements.json", R, N);
+  statreport(text);
+
+  return 0;
+}
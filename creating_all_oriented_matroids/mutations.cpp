@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+#include "OMs.h"
+#include "checkpoint.h"
+#include "stats.h"
+
+// This code finds representatives of all permutation/reorientation classes of
+// uniform oriented matroids of rank R on N elements without Finschi's lists:
+// it starts with the alternating chirotope (all bases positive) and walks the
+// mutation graph, whose edges change the sign of one basis. The classes are
+// found in breadth-first order and deduplicated by their canonical forms (see
+// canonicalOM()), and written to uniform_representatives_rankR_Nelements.txt,
+// the input of lower_cones.cpp. For R = 3 the mutation graph of the uniform
+// oriented matroids (simple pseudoline arrangements) is connected by Ringel's
+// theorem, so all classes are found; for larger R this is not known.
+//
+// A uniform chirotope satisfies the chirotope axioms iff it satisfies the
+// three-term Grassmann-Pluecker relations, so after the sign of the basis b
+// of a uniform chirotope changed, only the relations that contain b have to
+// be checked.
+//
+// The classes found so far are the queue of the search: the neighbours of
+// batches of them are found by a pool of threads, and the new classes are
+// added in the order of the queue, so the output does not depend on the
+// number of threads. Every checkpoint_interval seconds (and on SIGTERM) the
+// place in the queue is written to a checkpoint, the run can be continued
+// with --resume.
+
+// seconds between two checkpoints
+static const time_t checkpoint_interval = 600;
+
+// the relations that contain each basis, the six bases of a relation are
+// different
+static std::vector<std::vector<Relation>> makewatches() {
+  std::vector<std::vector<Relation>> watches(B);
+  for (const Relation &rel : makerelations())
+    for (int t = 0; t < 3; t++)
+      for (int k = 0; k < 2; k++)
+        watches[static_cast<size_t>(rel.bases[t][k])].push_back(rel);
+  return watches;
+}
+
+// the canonical forms of the uniform chirotopes that differ from M in the
+// sign of one basis
+static std::vector<OM>
+neighbours(const OM &M, const std::vector<std::vector<Relation>> &watches) {
+  signed char chi[B];
+  for (int b = 0; b < B; b++)
+    chi[b] = (M.plus[b >> 5] >> (b & 31) & 1) ? 1 : -1;
+
+  std::vector<OM> found;
+  for (int b = 0; b < B; b++) {
+    chi[b] = static_cast<signed char>(-chi[b]);
+
+    int good = 1;
+    for (const Relation &rel : watches[static_cast<size_t>(b)]) {
+      int positive = 0, negative = 0;
+      for (int t = 0; t < 3; t++) {
+        int x = rel.sign[t] * chi[rel.bases[t][0]] * chi[rel.bases[t][1]];
+        positive |= x > 0;
+        negative |= x < 0;
+      }
+      if (!positive || !negative) {
+        good = 0;
+        break;
+      }
+    }
+
+    if (good) {
+      OM X = M;
+      X.plus[b >> 5] ^= 1u << (b & 31);
+      X.minus[b >> 5] ^= 1u << (b & 31);
+      found.push_back(canonicalOM(X));
+    }
+    chi[b] = static_cast<signed char>(-chi[b]);
+  }
+
+  return found;
+}
+
+int main(int argc, char *argv[]) {
+  unsigned int nr_threads = std::thread::hardware_concurrency();
+  int resume = 0;
+  int i = 1;
+
+  while (i < argc) {
+    if (strcmp(argv[i], "--resume") == 0)
+      resume = 1;
+    else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+      nr_threads = static_cast<unsigned int>(atoi(argv[++i]));
+    else
+      break;
+    i++;
+  }
+  if (i < argc || R < 2 || N <= R) {
+    printf("Usage: %s [--resume] [-j threads]\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  char text[300];
+  char checkpoint[300];
+  Checkpoint C;
+  std::vector<OM> queue; // the classes in the order they are found
+  std::set<OM, decltype(&lessOM)> known(lessOM);
+
+  sprintf(checkpoint, "uniform_representatives_rank%d_%delements.checkpoint",
+          R, N);
+  if (resume && readcheckpoint(checkpoint, C) == 0) {
+    printf("No checkpoint %s found, starting from the beginning.\n",
+           checkpoint);
+    resume = 0;
+  }
+
+  sprintf(text, "uniform_representatives_rank%d_%delements.txt", R, N);
+  FILE *out = fopen(text, resume ? "r+" : "w");
+  if (out == NULL) {
+    fprintf(stderr, "error fopen():  Could not open text file %s.\n", text);
+    exit(EXIT_FAILURE);
+  }
+
+  if (resume) { // the classes written before the checkpoint are the queue
+    if (truncateoutput(out, C.offset) == 0) {
+      fprintf(stderr, "Could not truncate the file %s.\n", text);
+      exit(EXIT_FAILURE);
+    }
+    rewind(out);
+    OM M;
+    while (static_cast<long long>(queue.size()) < C.count && readOM(&M, out)) {
+      queue.push_back(M);
+      known.insert(M);
+    }
+    fseek(out, 0, SEEK_END);
+    printf("Resuming with %llu of %lld classes done.\n", C.counter, C.count);
+  } else {
+    fprintf(out,
+            "All uniform representatives (reorientations+permutations) of "
+            "rank %d on %d elements:\n",
+            R, N);
+    OM alternating;
+    for (int b = 0; b < B; b++)
+      alternating.plus[b >> 5] |= 1u << (b & 31);
+    OM M = canonicalOM(alternating);
+    queue.push_back(M);
+    known.insert(M);
+    writeOM(M, out);
+  }
+
+  installstophandler();
+
+  std::vector<std::vector<Relation>> watches = makewatches();
+  time_t last = time(NULL);
+  size_t head = C.counter;
+
+  statbegin("mutation graph");
+
+  while (head < queue.size()) {
+    size_t from = head, to = std::min(queue.size(), head + 4 * nr_threads);
+    std::vector<std::vector<OM>> found(to - from);
+    std::atomic<size_t> next{from};
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < nr_threads; t++)
+      threads.emplace_back([&] {
+        for (size_t k = next++; k < to; k = next++)
+          found[k - from] = neighbours(queue[k], watches);
+      });
+    for (auto &t : threads)
+      t.join();
+
+    for (const std::vector<OM> &f : found)
+      for (const OM &M : f)
+        if (known.insert(M).second) {
+          queue.push_back(M);
+          writeOM(M, out);
+        }
+    head = to;
+    statprogress(head, queue.size());
+
+    if (stop_requested || time(NULL) - last >= checkpoint_interval) {
+      C.counter = head;
+      C.count = static_cast<long long>(queue.size());
+      C.offset = outputoffset(out);
+      if (writecheckpoint(checkpoint, C) == 0)
+        fprintf(stderr, "Could not write the checkpoint %s.\n", checkpoint);
+      if (stop_requested) {
+        printf("Stopped after %zu of %zu classes.\n", head, queue.size());
+        fclose(out);
+        exit(EXIT_SUCCESS);
+      }
+      last = time(NULL);
+    }
+  }
+
+  statend(queue.size());
+
+  fclose(out);
+  remove(checkpoint); // the search is complete
+
+  printf("%zu classes of uniform oriented matroids\n", queue.size());
+
+  sprintf(text, "uniform_representatives_rank%d_%delements.json", R, N);
+  statreport(text);
+
+  return 0;
+}
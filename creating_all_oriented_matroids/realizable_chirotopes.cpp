@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OMs.h"
+#include "stats.h"
+
+// This code generates realizable chirotopes of rank R on N elements, e.g. as
+// inputs for the benchmarks and for testing at shapes where there is no
+// catalog. Every chirotope comes from a random configuration of N integer
+// vectors in Z^R with coordinates in [-bound, bound]; with probability
+// degenerate a vector is instead the sum of +-1 times up to R-1 of the random
+// vectors before it (parallel elements, collinear points in rank 3, coplanar
+// points in rank 4, ...), so that also non-uniform chirotopes appear.
+//
+// The signs of all R x R minors are computed exactly with fraction-free
+// Gaussian elimination (Bareiss). The bases are visited in their order, so
+// all bases with the same first k elements share the first k elimination
+// steps. The configurations are made in chunks, every chunk has its own
+// random generator, so the output depends only on the seed, not on the
+// number of threads.
+
+struct Matrix {
+  long long a[R][N]; // the vectors are the columns
+};
+
+static const unsigned long long chunk_size = 4096;
+
+// binomials.b[n][k] = n choose k
+struct Binomials {
+  int b[N + 1][R + 1];
+};
+
+static constexpr Binomials binomials = [] {
+  Binomials B{};
+  for (int n = 0; n <= N; n++) {
+    B.b[n][0] = 1;
+    for (int k = 1; k <= R && k <= n; k++)
+      B.b[n][k] = B.b[n - 1][k - 1] + (k < n ? B.b[n - 1][k] : 0);
+  }
+  return B;
+}();
+
+struct Elimination {
+  Matrix A[R];          // A[k] is the matrix after k elimination steps
+  long long pivot[R];   // the pivot of the step before k (1 for k=0)
+  int b;                // the next basis
+  signed char swaps[R]; // the sign of the row swaps of the first k steps
+  signed char sign[B];  // the chirotope
+  // keeps the struct free of padding
+  signed char reserved[8 - (4 + R + B) % 8];
+};
+
+// after the pivot columns c_0 < ... < c_{k-1}, the entry (i,j) of A[k] is the
+// minor on the rows 0,...,k-1,i and the columns c_0,...,c_{k-1},j; the next
+// pivot column is at least first
+static void eliminate(Elimination &E, int k, int first) {
+  const auto &A = E.A[k].a;
+
+  if (k == R - 1) { // the entries of the last row are the determinants
+    for (int c = first; c < N; c++) {
+      long long d = A[R - 1][c];
+      E.sign[E.b++] = static_cast<signed char>(d > 0   ? E.swaps[k]
+                                               : d < 0 ? -E.swaps[k]
+                                                       : 0);
+    }
+    return;
+  }
+
+  for (int c = first; c <= N - R + k; c++) {
+    int p = k;
+    while (p < R && A[p][c] == 0)
+      p++;
+
+    if (p == R) { // all bases that continue with c are dependent
+      for (int n = binomials.b[N - 1 - c][R - 1 - k]; n > 0; n--)
+        E.sign[E.b++] = 0;
+      continue;
+    }
+
+    // the rows p and k are swapped, then row k is the pivot row
+    auto &A1 = E.A[k + 1].a;
+    for (int i = k + 1; i < R; i++) {
+      int r = (i == p) ? k : i;
+      for (int j = c + 1; j < N; j++)
+        A1[i][j] = (A[p][c] * A[r][j] - A[r][c] * A[p][j]) / E.pivot[k];
+    }
+    E.pivot[k + 1] = A[p][c];
+    E.swaps[k + 1] =
+        static_cast<signed char>(p == k ? E.swaps[k] : -E.swaps[k]);
+
+    eliminate(E, k + 1, c + 1);
+  }
+}
+
+// the chirotope of the columns of A, returns 0 if A has rank < R
+static int realize(const Matrix &A, Elimination &E, OM &M) {
+  E.A[0] = A;
+  E.pivot[0] = 1;
+  E.swaps[0] = 1;
+  E.b = 0;
+  eliminate(E, 0, 0);
+
+  M = OM();
+  for (int i = 0; i < B; i++) {
+    if (E.sign[i] > 0)
+      M.plus[i >> 5] |= 1u << (i & 31);
+    else if (E.sign[i] < 0)
+      M.minus[i >> 5] |= 1u << (i & 31);
+  }
+
+  for (int i = 0; i < nr_ints; i++)
+    if (M.plus[i] || M.minus[i])
+      return 1;
+  return 0;
+}
+
+static void randomvectors(Matrix &M, std::mt19937_64 &rng, long long bound,
+                          double degenerate) {
+  std::uniform_int_distribution<long long> coordinate(-bound, bound);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  auto &A = M.a;
+  int free[N]; // the vectors that are not sums of others
+  int nr_free = 0;
+
+  for (int e = 0; e < N; e++) {
+    if (nr_free > 0 && uniform(rng) < degenerate) {
+      int k = 1 + static_cast<int>(rng() % static_cast<unsigned long long>(
+                                              std::min(R - 1, nr_free)));
+      std::shuffle(free, free + nr_free, rng);
+      for (int i = 0; i < R; i++)
+        A[i][e] = 0;
+      for (int f = 0; f < k; f++) {
+        long long s = (rng() & 1) ? 1 : -1;
+        for (int i = 0; i < R; i++)
+          A[i][e] += s * A[i][free[f]];
+      }
+    } else {
+      for (int i = 0; i < R; i++)
+        A[i][e] = coordinate(rng);
+      free[nr_free++] = e;
+    }
+  }
+}
+
+// the largest intermediate product of the elimination is at most the square
+// of Hadamard's bound (sqrt(R) * C)^R, where C = (R-1) * bound is the largest
+// coordinate; it has to fit into a long long
+static int fits(long long bound) {
+  double C =
+      static_cast<double>(std::max(R - 1, 1)) * static_cast<double>(bound);
+  return 2 * R * log2(sqrt(static_cast<double>(R)) * C) < 62;
+}
+
+struct Options {
+  unsigned long long count;
+  unsigned long long seed = 1;
+  long long bound = 0;
+  double degenerate = 0.1;
+  int verify = 0;
+  int reserved = 0; // keeps the struct free of padding
+};
+
+static std::atomic<unsigned long long> nr_failed(0);
+
+// makes the chirotopes of the chunk and writes them to text
+static void makechunk(const Options &O, unsigned long long chunk,
+                      std::string &text) {
+  std::seed_seq seq{static_cast<unsigned int>(O.seed),
+                    static_cast<unsigned int>(O.seed >> 32),
+                    static_cast<unsigned int>(chunk),
+                    static_cast<unsigned int>(chunk >> 32)};
+  std::mt19937_64 rng(seq);
+
+  Matrix A;
+  Elimination E;
+  OM M;
+  unsigned long long n = std::min(chunk_size, O.count - chunk * chunk_size);
+
+  text.clear();
+  text.reserve(n * (B + 1));
+
+  for (unsigned long long i = 0; i < n; i++) {
+    do
+      randomvectors(A, rng, O.bound, O.degenerate);
+    while (realize(A, E, M) == 0);
+
+    if (O.verify && ischirotope(M) == 0)
+      nr_failed++;
+
+    for (int b = 0; b < B; b++)
+      text.push_back(E.sign[b] > 0 ? '+' : E.sign[b] < 0 ? '-' : '0');
+    text.push_back('\n');
+  }
+}
+
+int main(int argc, char *argv[]) {
+  unsigned int nr_threads = std::thread::hardware_concurrency();
+  Options O;
+  char output[300];
+  sprintf(output, "realizable_rank%d_%delements.txt", R, N);
+
+  int i = 1;
+  while (i < argc && argv[i][0] == '-') {
+    if (strcmp(argv[i], "-v") == 0) {
+      O.verify = 1;
+      i++;
+      continue;
+    }
+    if (i + 1 >= argc)
+      break;
+    if (strcmp(argv[i], "-j") == 0)
+      nr_threads = static_cast<unsigned int>(atoi(argv[i + 1]));
+    else if (strcmp(argv[i], "-s") == 0)
+      O.seed = strtoull(argv[i + 1], NULL, 10);
+    else if (strcmp(argv[i], "-c") == 0)
+      O.bound = atoll(argv[i + 1]);
+    else if (strcmp(argv[i], "-d") == 0)
+      O.degenerate = atof(argv[i + 1]);
+    else if (strcmp(argv[i], "-o") == 0)
+      snprintf(output, sizeof(output), "%s", argv[i + 1]);
+    else
+      break;
+    i += 2;
+  }
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  if (i + 1 != argc) {
+    printf("Usage: %s [-j threads] [-s seed] [-c bound] [-d degenerate] [-v] "
+           "[-o output] count\n",
+           argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  O.count = strtoull(argv[i], NULL, 10);
+
+  if (O.bound == 0) // the largest bound that is safe, but at most 1000
+    for (O.bound = 1000; O.bound > 1 && !fits(O.bound); O.bound--)
+      ;
+  if (O.bound < 1 || !fits(O.bound)) {
+    fprintf(stderr, "The bound %lld is too large for rank %d.\n", O.bound, R);
+    exit(EXIT_FAILURE);
+  }
+
+  FILE *out = fopen(output, "w");
+  if (out == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", output);
+    exit(EXIT_FAILURE);
+  }
+  fprintf(out,
+          "Realizable chirotopes of %llu random vector configurations of rank "
+          "%d on %d elements:\n",
+          O.count, R, N);
+
+  // the chunks are made in windows of several chunks per thread and written
+  // in their order
+  unsigned long long nr_chunks = (O.count + chunk_size - 1) / chunk_size;
+  unsigned long long window = 4ull * nr_threads;
+  std::vector<std::string> texts(window);
+
+  statbegin("realizable chirotopes");
+
+  for (unsigned long long first = 0; first < nr_chunks; first += window) {
+    unsigned long long last = std::min(first + window, nr_chunks);
+    std::vector<std::thread> threads;
+    for (unsigned long long t = 0; t < nr_threads; t++)
+      threads.emplace_back([&, t] {
+        for (unsigned long long c = first + t; c < last; c += nr_threads)
+          makechunk(O, c, texts[c - first]);
+      });
+    for (auto &t : threads)
+      t.join();
+
+    for (unsigned long long c = first; c < last; c++)
+      fwrite(texts[c - first].data(), 1, texts[c - first].size(), out);
+    statprogress(last, nr_chunks);
+  }
+
+  statend(O.count);
+  fclose(out);
+
+  printf("%llu chirotopes written to %s (coordinates in [-%lld, %lld])\n",
+         O.count, output, O.bound, O.bound);
+
+  char text[300];
+  sprintf(text, "realizable_rank%d_%delements.json", R, N);
+  statreport(text);
+
+  if (O.verify) {
+    printf("%llu of them are not chirotopes\n", nr_failed.load());
+    if (nr_failed > 0)
+      exit(EXIT_FAILURE);
+  }
+
+  return 0;
+}
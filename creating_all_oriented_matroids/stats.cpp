@@ -0,0 +1,192 @@
+#include "stats.h"
+
+#ifdef OM_STATS
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "OMs.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const char *counter_names[stat_nr_counters] = {
+    "ischirotope", "rejected_plus_minus", "rejected_b0",
+    "rejected_b2prime", "permute", "isequal"};
+
+// the hardware events read for every phase
+static const char *perf_names[] = {"cycles", "instructions", "cache_misses",
+                                   "branch_misses"};
+static const int nr_perf = 4;
+
+struct Phase {
+  std::string name;
+  double seconds = 0;
+  unsigned long long items = 0;
+  long long perf[nr_perf] = {-1, -1, -1, -1};
+};
+
+static std::mutex stat_mutex;
+static std::vector<std::unique_ptr<StatBlock>> blocks;
+static std::vector<Phase> phases;
+static Clock::time_point program_begin = Clock::now();
+static Clock::time_point phase_begin;
+static Clock::time_point last_progress;
+static int perf_fd[nr_perf] = {-1, -1, -1, -1};
+static long long perf_begin[nr_perf];
+
+StatBlock &statblock() {
+  std::lock_guard<std::mutex> lock(stat_mutex);
+  blocks.push_back(std::make_unique<StatBlock>());
+  for (auto &c : blocks.back()->c)
+    c.store(0, std::memory_order_relaxed);
+  return *blocks.back();
+}
+
+static long long readperf(int fd) {
+#if defined(__linux__)
+  long long value;
+  if (fd >= 0 && read(fd, &value, sizeof(value)) == sizeof(value))
+    return value;
+#endif
+  (void)fd;
+  return -1;
+}
+
+static void openperf() {
+#if defined(__linux__)
+  static const unsigned long long configs[nr_perf] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+  if (getenv("OM_PERF") == NULL)
+    return;
+
+  for (int i = 0; i < nr_perf; i++) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = configs[i];
+    attr.inherit = 1; // the threads of the phase are counted as well
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    perf_fd[i] =
+        static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    perf_begin[i] = readperf(perf_fd[i]);
+  }
+#endif
+}
+
+static void closeperf(Phase &P) {
+  for (int i = 0; i < nr_perf; i++) {
+    if (perf_fd[i] < 0)
+      continue;
+    long long value = readperf(perf_fd[i]);
+    if (value >= 0 && perf_begin[i] >= 0)
+      P.perf[i] = value - perf_begin[i];
+#if defined(__linux__)
+    close(perf_fd[i]);
+#endif
+    perf_fd[i] = -1;
+  }
+}
+
+static unsigned long long total(StatCounter c) {
+  unsigned long long sum = 0;
+  for (const auto &b : blocks)
+    sum += b->c[c].load(std::memory_order_relaxed);
+  return sum;
+}
+
+void statbegin(const char *phase) {
+  std::lock_guard<std::mutex> lock(stat_mutex);
+  phases.push_back(Phase());
+  phases.back().name = phase;
+  phase_begin = Clock::now();
+  last_progress = phase_begin;
+  openperf();
+}
+
+void statend(unsigned long long items) {
+  std::lock_guard<std::mutex> lock(stat_mutex);
+  if (phases.empty())
+    return;
+  Phase &P = phases.back();
+  P.seconds =
+      std::chrono::duration<double>(Clock::now() - phase_begin).count();
+  P.items = items;
+  closeperf(P);
+  printf("[stats] %s: %.2f s, %llu candidates, %.0f candidates/s\n",
+         P.name.c_str(), P.seconds, P.items,
+         P.seconds > 0 ? static_cast<double>(P.items) / P.seconds : 0.0);
+}
+
+void statprogress(unsigned long long done, unsigned long long all) {
+  auto now = Clock::now();
+  if (now - last_progress < std::chrono::seconds(10) || done == 0)
+    return;
+  last_progress = now;
+
+  double seconds = std::chrono::duration<double>(now - phase_begin).count();
+  double rate = static_cast<double>(done) / seconds;
+  double eta = static_cast<double>(all - done) / rate;
+  long long e = static_cast<long long>(eta);
+
+  printf("[stats] %s: %.2f%%, %.0f candidates/s, ETA %lld:%02lld:%02lld\n",
+         phases.empty() ? "" : phases.back().name.c_str(),
+         100.0 * static_cast<double>(done) / static_cast<double>(all), rate,
+         e / 3600, e / 60 % 60, e % 60);
+  fflush(stdout);
+}
+
+void statreport(const char *name) {
+  std::lock_guard<std::mutex> lock(stat_mutex);
+
+  FILE *out = fopen(name, "w");
+  if (out == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", name);
+    return;
+  }
+
+  double seconds =
+      std::chrono::duration<double>(Clock::now() - program_begin).count();
+
+  fprintf(out, "{\n  \"rank\": %d,\n  \"elements\": %d,\n", R, N);
+  fprintf(out, "  \"seconds\": %.3f,\n  \"counters\": {\n", seconds);
+  for (int c = 0; c < stat_nr_counters; c++)
+    fprintf(out, "    \"%s\": %llu,\n", counter_names[c],
+            total(static_cast<StatCounter>(c)));
+  fprintf(out, "    \"accepted\": %llu\n  },\n  \"phases\": [",
+          total(stat_ischirotope) - total(stat_reject_plusminus) -
+              total(stat_reject_b0) - total(stat_reject_b2prime));
+
+  for (size_t i = 0; i < phases.size(); i++) {
+    const Phase &P = phases[i];
+    fprintf(out,
+            "%s\n    {\"name\": \"%s\", \"seconds\": %.3f, \"items\": %llu, "
+            "\"items_per_second\": %.1f",
+            i ? "," : "", P.name.c_str(), P.seconds, P.items,
+            P.seconds > 0 ? static_cast<double>(P.items) / P.seconds : 0.0);
+    for (int k = 0; k < nr_perf; k++)
+      if (P.perf[k] >= 0)
+        fprintf(out, ", \"%s\": %lld", perf_names[k], P.perf[k]);
+    fputc('}', out);
+  }
+  fprintf(out, "\n  ]\n}\n");
+
+  fclose(out);
+}
+
+#endif // OM_STATS
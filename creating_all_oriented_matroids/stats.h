@@ -0,0 +1,67 @@
+#ifndef STATS_H
+#define STATS_H
+
+// Instrumentation of the programs: counters in the hot functions of OMs.cpp,
+// timed phases with throughput, progress lines with an estimate of the
+// remaining time and a final report in JSON. Everything is compiled only with
+// -DOM_STATS (the CMake option OM_STATS), otherwise the functions below are
+// empty and the counters cost nothing.
+//
+// If the environment variable OM_PERF is set, the hardware counters (cycles,
+// instructions, cache misses, branch misses) are read via perf_event_open for
+// every phase.
+
+#ifdef OM_STATS
+#include <atomic>
+#include <stdint.h>
+#endif
+
+enum StatCounter {
+  stat_ischirotope,          // calls of ischirotope
+  stat_reject_plusminus,     // a basis is both positive and negative
+  stat_reject_b0,            // all bases are zero
+  stat_reject_b2prime,       // Axiom B2' is violated
+  stat_permute,              // calls of permute
+  stat_isequal,              // calls of isequal
+  stat_nr_counters
+};
+
+#ifdef OM_STATS
+
+// the counters of one thread, only the thread itself writes them
+struct StatBlock {
+  std::atomic<uint64_t> c[stat_nr_counters];
+};
+
+// the block of the calling thread, it is registered on the first call
+StatBlock &statblock();
+
+inline void statcount(StatCounter c) {
+  thread_local StatBlock &b = statblock();
+  b.c[c].store(b.c[c].load(std::memory_order_relaxed) + 1,
+               std::memory_order_relaxed);
+}
+
+// starts a new phase of the program
+void statbegin(const char *phase);
+
+// ends the current phase, items is the number of candidates it processed
+void statend(unsigned long long items);
+
+// prints a progress line (at most every few seconds) for the current phase
+void statprogress(unsigned long long done, unsigned long long total);
+
+// writes all counters and phases to the file name in JSON
+void statreport(const char *name);
+
+#else
+
+inline void statcount(StatCounter) {}
+inline void statbegin(const char *) {}
+inline void statend(unsigned long long) {}
+inline void statprogress(unsigned long long, unsigned long long) {}
+inline void statreport(const char *) {}
+
+#endif // OM_STATS
+
+#endif // STATS_H
@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "OMs.h"
+#include "hasse.h"
+#include "stats.h"
+
+// This code reads oriented matroids of rank R on N elements from catalog files
+// (the lists of all oriented matroids sorted by the number of bases) and
+// constructs the Hasse diagram of the weak map order, i.e. all cover
+// relations of MacP(R,N). The diagram is stored in the file
+// hasse_rankR_Nelements.csr, see hasse.h.
+
+int main(int argc, char *argv[]) {
+  unsigned int nr_threads = std::thread::hardware_concurrency();
+  int first_file = 1;
+
+  if (argc > 2 && strcmp(argv[1], "-j") == 0) {
+    nr_threads = static_cast<unsigned int>(atoi(argv[2]));
+    first_file = 3;
+  }
+
+  if (first_file >= argc) {
+    printf("Usage: %s [-j threads] catalog files...\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<OM> oms;
+  statbegin("reading the catalogs");
+  if (readcatalogs(oms, argc - first_file, argv + first_file) == 0)
+    exit(EXIT_FAILURE);
+  statend(oms.size());
+
+  printf("%zu oriented matroids\n", oms.size());
+
+  statbegin("cover relations");
+  HasseDiagram H = makehasse(std::move(oms), nr_threads);
+  statend(H.nodes.size());
+
+  char text[300];
+  sprintf(text, "hasse_rank%d_%delements.csr", R, N);
+  FILE *out = fopen(text, "wb");
+  if (out == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", text);
+    exit(EXIT_FAILURE);
+  }
+  if (writehasse(H, out) == 0) {
+    fprintf(stderr, "Could not write the file %s.\n", text);
+    exit(EXIT_FAILURE);
+  }
+  fclose(out);
+
+  printf("%zu cover relations\n", H.targets.size());
+
+  sprintf(text, "hasse_rank%d_%delements.json", R, N);
+  statreport(text);
+
+  return 0;
+}
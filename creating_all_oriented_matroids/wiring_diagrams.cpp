@@ -0,0 +1,381 @@
+#include <algorithm>
+#include <array>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include "OMs.h"
+#include "classes.h"
+#include "stats.h"
+
+// This code finds representatives of all permutation/reorientation classes of
+// uniform oriented matroids of rank 3 on N elements, i.e. of the simple
+// arrangements of N pseudolines, from those on N-1 elements without checking
+// any chirotope axioms.
+//
+// Every class has presentations with chi(a,b,N-1) = + for all a < b < N-1:
+// any element e reoriented either way becomes N-1, and the others are the
+// vectors of the contraction by e in a half-plane, numbered in their cyclic
+// order (4 N (N-1) presentations, see presentations()). These chirotopes are
+// the wiring diagrams of N-1 wires, i.e. the allowable sequences of adjacent
+// transpositions from 0 1 ... N-2 to N-2 ... 1 0 up to commutations: N-1 is
+// the line at infinity, and for the wires a < b < c the sign chi(a,b,c) is +
+// if they cross in the order ab, ac, bc and - if in the order bc, ac, ab.
+//
+// Deleting the top wire N-2 of a wiring diagram leaves the wiring diagram of a
+// presentation of a class on N-1 elements, and the top wire goes back along
+// the order ideal of the crossings left of it; every order ideal gives a
+// wiring diagram (see insertwire()). So all wiring diagrams of N-1 wires are
+// made from the presentations of the classes on N-1 elements, and their
+// classes are told apart by the smallest presentation, which costs 4 N (N-1)
+// steps instead of the N! 2^(N-1) of canonicalOM().
+//
+// The input are representatives on N-1 elements, e.g. the output of this code
+// or of mutation_graph for N-1; for N = 4 there is no input. The smallest
+// presentations of the classes (not the canonical forms of canonicalOM())
+// are written in the order of the input to
+// uniform_representatives_rank3_Nelements.txt, the input of lower_cones.cpp.
+
+// the signs of a uniform chirotope on 0, ..., n-1 for all ordered triples
+struct Table {
+  signed char chi[N][N][N];
+  signed char n; // a char like chi, so that the struct is not padded
+};
+
+using Triple = std::array<int, 3>;
+
+// the element perm[i], reoriented by sign[i], is i in the presentation
+struct Presentation {
+  int perm[N];
+  int sign[N];
+};
+
+// the crossings of a wiring diagram in the order of a reduced word, and the
+// crossings just before them on their two wires (-1 if there is none)
+struct Diagram {
+  std::vector<std::array<int, 2>> wires; // the lower number first
+  std::vector<std::array<int, 2>> before;
+};
+
+static void setsign(Table &T, int a, int b, int c, int s) {
+  signed char x = static_cast<signed char>(s);
+  signed char y = static_cast<signed char>(-s);
+  T.chi[a][b][c] = T.chi[b][c][a] = T.chi[c][a][b] = x;
+  T.chi[b][a][c] = T.chi[a][c][b] = T.chi[c][b][a] = y;
+}
+
+// the triples a < b < c < n-1 in colexicographic order, the triples with n-1
+// are positive in all presentations
+static std::vector<Triple> colex(int n) {
+  std::vector<Triple> order;
+  for (int c = 2; c < n - 1; c++)
+    for (int b = 1; b < c; b++)
+      for (int a = 0; a < b; a++)
+        order.push_back({a, b, c});
+  return order;
+}
+
+static int value(const Table &T, const Presentation &P, const Triple &t) {
+  return P.sign[t[0]] * P.sign[t[1]] * P.sign[t[2]] *
+         T.chi[P.perm[t[0]]][P.perm[t[1]]][P.perm[t[2]]];
+}
+
+// calls f for all presentations of T with chi(a,b,n-1) = + for a < b < n-1
+template <typename F> static void presentations(const Table &T, F f) {
+  int n = T.n;
+  int others[N], eps[N];
+  int cyclic[2 * N][2]; // the vectors of the contraction and their signs
+  Presentation P;
+
+  for (int e = 0; e < n; e++) {
+    int k = 0;
+    for (int x = 0; x < n; x++)
+      if (x != e)
+        others[k++] = x;
+
+    // all others reoriented into the half-plane that starts with others[0]
+    eps[others[0]] = 1;
+    for (int i = 1; i < n - 1; i++)
+      eps[others[i]] = T.chi[others[0]][others[i]][e];
+    std::sort(others + 1, others + n - 1, [&](int x, int y) {
+      return eps[x] * eps[y] * T.chi[x][y][e] > 0;
+    });
+    for (int i = 0; i < n - 1; i++) {
+      cyclic[i][0] = cyclic[i + n - 1][0] = others[i];
+      cyclic[i][1] = eps[others[i]];
+      cyclic[i + n - 1][1] = -eps[others[i]];
+    }
+
+    // n-1 consecutive vectors, in reverse order if e is reoriented
+    P.perm[n - 1] = e;
+    for (int r = 0; r < 2 * (n - 1); r++)
+      for (int d : {1, -1}) {
+        for (int i = 0; i < n - 1; i++) {
+          int j = (r + (d > 0 ? i : n - 2 - i)) % (2 * (n - 1));
+          P.perm[i] = cyclic[j][0];
+          P.sign[i] = cyclic[j][1];
+        }
+        P.sign[n - 1] = d;
+        f(P);
+      }
+  }
+}
+
+// the smallest presentation of T (n = N), comparing the triples in the given
+// order, as an oriented matroid
+static OM smallest(const Table &T, const std::vector<Triple> &order) {
+  signed char best[B];
+  Presentation Q;
+  int first = 1;
+
+  presentations(T, [&](const Presentation &P) {
+    size_t k = 0;
+    if (!first) {
+      for (; k < order.size(); k++) {
+        int v = value(T, P, order[k]);
+        if (v > best[k])
+          return;
+        if (v < best[k])
+          break;
+      }
+      if (k == order.size())
+        return;
+    }
+    first = 0;
+    for (; k < order.size(); k++)
+      best[k] = static_cast<signed char>(value(T, P, order[k]));
+    Q = P;
+  });
+
+  OM M;
+  for (int b = 0; b < B; b++) {
+    size_t s = static_cast<size_t>(b);
+    Triple t = {bases[s, 0], bases[s, 1], bases[s, 2]};
+    if (value(T, Q, t) > 0)
+      M.plus[b >> 5] |= 1u << (b & 31);
+    else
+      M.minus[b >> 5] |= 1u << (b & 31);
+  }
+  return M;
+}
+
+static Table relabel(const Table &T, const Presentation &P) {
+  Table X;
+  X.n = T.n;
+  for (int c = 2; c < T.n; c++)
+    for (int b = 1; b < c; b++)
+      for (int a = 0; a < b; a++)
+        setsign(X, a, b, c, value(T, P, {a, b, c}));
+  return X;
+}
+
+// the wiring diagram of a presentation T: the wires are 0, ..., T.n-2 from
+// the bottom to the top on the left, and for a < b < c the wire b crosses a
+// before c iff chi(a,b,c) = +, the wires a and c cross b in the same order
+static Diagram makediagram(const Table &T) {
+  int m = T.n - 1;
+  std::vector<std::vector<int>> along(static_cast<size_t>(m));
+  for (int w = 0; w < m; w++) {
+    std::vector<int> &s = along[static_cast<size_t>(w)];
+    for (int x = 0; x < m; x++)
+      if (x != w)
+        s.push_back(x);
+    std::sort(s.begin(), s.end(), [&](int x, int y) {
+      return ((x < w) != (y < w) ? -1 : 1) * T.chi[w][x][y] > 0;
+    });
+  }
+
+  Diagram D;
+  std::vector<int> wire(static_cast<size_t>(m)); // the wire at each place
+  std::vector<size_t> next(static_cast<size_t>(m), 0);
+  std::vector<int> last(static_cast<size_t>(m), -1);
+  for (int p = 0; p < m; p++)
+    wire[static_cast<size_t>(p)] = p;
+
+  // two neighbouring wires cross if each is the next crossing of the other
+  size_t nr_crossings = static_cast<size_t>(m * (m - 1) / 2);
+  while (D.wires.size() < nr_crossings) {
+    size_t p;
+    for (p = 0; p + 1 < static_cast<size_t>(m); p++) {
+      size_t a = static_cast<size_t>(wire[p]);
+      size_t b = static_cast<size_t>(wire[p + 1]);
+      if (next[a] < along[a].size() && along[a][next[a]] == wire[p + 1] &&
+          along[b][next[b]] == wire[p]) {
+        D.wires.push_back({std::min(wire[p], wire[p + 1]),
+                           std::max(wire[p], wire[p + 1])});
+        D.before.push_back({last[a], last[b]});
+        last[a] = last[b] = static_cast<int>(D.wires.size()) - 1;
+        next[a]++;
+        next[b]++;
+        std::swap(wire[p], wire[p + 1]);
+        break;
+      }
+    }
+    if (p + 1 >= static_cast<size_t>(m)) {
+      fprintf(stderr, "A representative is not a chirotope.\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  return D;
+}
+
+// puts the new top wire t = N-2 of X along all order ideals of the crossings
+// of D, the crossings from k on are not decided yet; chi(i,j,t) = + iff the
+// crossing of i and j is left of t
+static void insertwire(const Diagram &D, size_t k, std::vector<char> &left,
+                       Table &X, const std::vector<Triple> &order,
+                       std::vector<OM> &found) {
+  if (k == D.wires.size()) {
+    found.push_back(smallest(X, order));
+    return;
+  }
+
+  int i = D.wires[k][0], j = D.wires[k][1];
+  int p = D.before[k][0], q = D.before[k][1];
+  if ((p < 0 || left[static_cast<size_t>(p)]) &&
+      (q < 0 || left[static_cast<size_t>(q)])) {
+    left[k] = 1;
+    setsign(X, i, j, N - 2, 1);
+    insertwire(D, k + 1, left, X, order, found);
+  }
+  left[k] = 0;
+  setsign(X, i, j, N - 2, -1);
+  insertwire(D, k + 1, left, X, order, found);
+}
+
+// the smallest presentations of the classes of all wiring diagrams whose top
+// wire can be deleted to leave a presentation of M on N-1 elements, sorted
+static std::vector<OM> extensions(const OM &M,
+                                  const std::vector<Triple> &smallorder,
+                                  const std::vector<Triple> &order) {
+  Table T;
+  T.n = N - 1;
+  int i = 0;
+  for (int b = 0; b < B; b++) {
+    size_t s = static_cast<size_t>(b);
+    if (bases[s, 2] == N - 1)
+      continue;
+    setsign(T, bases[s, 0], bases[s, 1], bases[s, 2],
+            (M.plus[i >> 5] >> (i & 31) & 1) ? 1 : -1);
+    i++;
+  }
+
+  std::vector<OM> found;
+  std::set<std::vector<signed char>> seen; // presentations of symmetric M
+  presentations(T, [&](const Presentation &P) {
+    std::vector<signed char> key;
+    for (const Triple &t : smallorder)
+      key.push_back(static_cast<signed char>(value(T, P, t)));
+    if (!seen.insert(key).second)
+      return;
+
+    Table Y = relabel(T, P);
+    Diagram D = makediagram(Y);
+
+    Table X;
+    X.n = N;
+    for (const Triple &t : smallorder) // the old wires
+      setsign(X, t[0], t[1], t[2], Y.chi[t[0]][t[1]][t[2]]);
+    for (int b = 1; b < N - 1; b++) // the line at infinity
+      for (int a = 0; a < b; a++)
+        setsign(X, a, b, N - 1, 1);
+
+    std::vector<char> left(D.wires.size(), 0);
+    insertwire(D, 0, left, X, order, found);
+  });
+
+  std::sort(found.begin(), found.end(), lessOM);
+  found.erase(std::unique(found.begin(), found.end(),
+                          [](const OM &a, const OM &b) {
+                            return compareOM(a, b) == 0;
+                          }),
+              found.end());
+  return found;
+}
+
+int main(int argc, char *argv[]) {
+  unsigned int nr_threads = std::thread::hardware_concurrency();
+  int i = 1;
+
+  if (i + 1 < argc && strcmp(argv[i], "-j") == 0) {
+    nr_threads = static_cast<unsigned int>(atoi(argv[i + 1]));
+    i += 2;
+  }
+  if (R != 3) {
+    fprintf(stderr, "Wiring diagrams are only for rank 3, not for rank %d.\n",
+            R);
+    exit(EXIT_FAILURE);
+  }
+  if (N < 4 || (i >= argc && N != 4)) {
+    printf("Usage: %s [-j threads] files...\n"
+           "The files are representatives of the uniform oriented matroids "
+           "of rank 3 on %d elements (none for 4 elements).\n",
+           argv[0], N - 1);
+    exit(EXIT_FAILURE);
+  }
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  std::vector<OM> input;
+  OM M;
+  if (i >= argc) { // the only uniform oriented matroid on 3 elements
+    M.plus[0] = 1;
+    input.push_back(M);
+  }
+  for (; i < argc; i++) {
+    FILE *in = fopen(argv[i], "r");
+    if (in == NULL) {
+      fprintf(stderr, "error fopen():  Could not open the file %s.\n",
+              argv[i]);
+      exit(EXIT_FAILURE);
+    }
+    while (readsmaller(M, in, 1))
+      input.push_back(M);
+    fclose(in);
+  }
+
+  std::vector<Triple> smallorder = colex(N - 1), order = colex(N);
+
+  char text[300];
+  sprintf(text, "uniform_representatives_rank%d_%delements.txt", R, N);
+  FILE *out = fopen(text, "w");
+  if (out == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", text);
+    exit(EXIT_FAILURE);
+  }
+  fprintf(out,
+          "All uniform representatives (reorientations+permutations) of "
+          "rank %d on %d elements:\n",
+          R, N);
+
+  statbegin("wiring diagrams");
+
+  // the classes are written in the order of the input, each the first time
+  // it is found
+  std::set<OM, decltype(&lessOM)> classes(lessOM);
+  orderedpool(
+      input.size(), nr_threads,
+      [&](size_t k) { return extensions(input[k], smallorder, order); },
+      [&](size_t k, const std::vector<OM> &found) {
+        for (const OM &X : found)
+          if (classes.insert(X).second)
+            writeOM(X, out);
+        fflush(out);
+        statprogress(k + 1, input.size());
+      });
+
+  statend(input.size());
+
+  fclose(out);
+
+  printf("%zu classes of uniform oriented matroids\n", classes.size());
+
+  sprintf(text, "wiring_diagrams_rank%d_%delements.json", R, N);
+  statreport(text);
+
+  return 0;
+}
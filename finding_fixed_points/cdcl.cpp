@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <utility>
+
+#include "cdcl.h"
+
+// 1 if the literal is true, 0 if it is false, -1 if it is not assigned
+static int litvalue(const Solver &S, int lit) {
+  int v = S.value[static_cast<size_t>(lit >> 1)];
+  return v < 0 ? -1 : v ^ (lit & 1);
+}
+
+static int decisionlevel(const Solver &S) {
+  return static_cast<int>(S.trail_lim.size());
+}
+
+// the heap of the unassigned variables, the one with the highest activity
+// first
+
+static int before(const Solver &S, int a, int b) {
+  return S.activity[static_cast<size_t>(a)] >
+         S.activity[static_cast<size_t>(b)];
+}
+
+static void heapswap(Solver &S, size_t i, size_t j) {
+  std::swap(S.heap[i], S.heap[j]);
+  S.heap_index[static_cast<size_t>(S.heap[i])] = static_cast<int>(i);
+  S.heap_index[static_cast<size_t>(S.heap[j])] = static_cast<int>(j);
+}
+
+static void heapup(Solver &S, size_t i) {
+  while (i > 0 && before(S, S.heap[i], S.heap[(i - 1) / 2])) {
+    heapswap(S, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+static void heapdown(Solver &S, size_t i) {
+  for (;;) {
+    size_t best = i, l = 2 * i + 1, r = 2 * i + 2;
+    if (l < S.heap.size() && before(S, S.heap[l], S.heap[best]))
+      best = l;
+    if (r < S.heap.size() && before(S, S.heap[r], S.heap[best]))
+      best = r;
+    if (best == i)
+      return;
+    heapswap(S, i, best);
+    i = best;
+  }
+}
+
+static void heapinsert(Solver &S, int var) {
+  if (S.heap_index[static_cast<size_t>(var)] >= 0)
+    return;
+  S.heap_index[static_cast<size_t>(var)] = static_cast<int>(S.heap.size());
+  S.heap.push_back(var);
+  heapup(S, S.heap.size() - 1);
+}
+
+static int heappop(Solver &S) {
+  int var = S.heap[0];
+  heapswap(S, 0, S.heap.size() - 1);
+  S.heap.pop_back();
+  S.heap_index[static_cast<size_t>(var)] = -1;
+  if (!S.heap.empty())
+    heapdown(S, 0);
+  return var;
+}
+
+static void bump(Solver &S, int var) {
+  double &a = S.activity[static_cast<size_t>(var)];
+  a += S.var_inc;
+  if (a > 1e100) { // rescale all activities
+    for (double &b : S.activity)
+      b *= 1e-100;
+    S.var_inc *= 1e-100;
+  }
+  if (S.heap_index[static_cast<size_t>(var)] >= 0)
+    heapup(S, static_cast<size_t>(S.heap_index[static_cast<size_t>(var)]));
+}
+
+int newvar(Solver &S) {
+  int var = S.nr_vars++;
+  S.value.push_back(-1);
+  S.level.push_back(0);
+  S.reason.push_back(-1);
+  S.activity.push_back(0);
+  S.phase.push_back(0);
+  S.heap_index.push_back(-1);
+  S.seen.push_back(0);
+  S.watches.resize(2 * static_cast<size_t>(S.nr_vars));
+  heapinsert(S, var);
+  return var;
+}
+
+static void enqueue(Solver &S, int lit, int reason) {
+  size_t var = static_cast<size_t>(lit >> 1);
+  S.value[var] = static_cast<signed char>((lit & 1) ^ 1);
+  S.level[var] = decisionlevel(S);
+  S.reason[var] = reason;
+  S.trail.push_back(lit);
+}
+
+static void backtrack(Solver &S, int level) {
+  if (decisionlevel(S) <= level)
+    return;
+  size_t first = S.trail_lim[static_cast<size_t>(level)];
+  while (S.trail.size() > first) {
+    int var = S.trail.back() >> 1;
+    S.phase[static_cast<size_t>(var)] = S.value[static_cast<size_t>(var)];
+    S.value[static_cast<size_t>(var)] = -1;
+    S.reason[static_cast<size_t>(var)] = -1;
+    heapinsert(S, var);
+    S.trail.pop_back();
+  }
+  S.trail_lim.resize(static_cast<size_t>(level));
+  S.qhead = S.trail.size();
+}
+
+// propagates the assigned literals, returns the conflicting clause or -1
+static int propagate(Solver &S) {
+  while (S.qhead < S.trail.size()) {
+    int f = S.trail[S.qhead++] ^ 1; // this literal became false
+    std::vector<int> &ws = S.watches[static_cast<size_t>(f)];
+    size_t i = 0, j = 0;
+
+    while (i < ws.size()) {
+      int ci = ws[i++];
+      std::vector<int> &c = S.clauses[static_cast<size_t>(ci)];
+      if (c[0] == f) // the false literal is c[1]
+        std::swap(c[0], c[1]);
+      if (litvalue(S, c[0]) == 1) {
+        ws[j++] = ci;
+        continue;
+      }
+
+      int moved = 0; // look for a new literal to watch
+      for (size_t k = 2; k < c.size(); k++)
+        if (litvalue(S, c[k]) != 0) {
+          std::swap(c[1], c[k]);
+          S.watches[static_cast<size_t>(c[1])].push_back(ci);
+          moved = 1;
+          break;
+        }
+      if (moved)
+        continue;
+
+      ws[j++] = ci;
+      if (litvalue(S, c[0]) == 0) { // all literals are false
+        while (i < ws.size())
+          ws[j++] = ws[i++];
+        ws.resize(j);
+        return ci;
+      }
+      enqueue(S, c[0], ci);
+    }
+    ws.resize(j);
+  }
+
+  return -1;
+}
+
+// the clause learnt from the conflict, its first literal is the one of the
+// current level; returns the level to go back to
+static int analyze(Solver &S, int conflict, std::vector<int> &learnt) {
+  learnt.assign(1, 0);
+  int counter = 0, p = -1;
+  size_t index = S.trail.size();
+  int ci = conflict;
+
+  do {
+    const std::vector<int> &c = S.clauses[static_cast<size_t>(ci)];
+    for (size_t k = (p < 0 ? 0 : 1); k < c.size(); k++) {
+      size_t var = static_cast<size_t>(c[k] >> 1);
+      if (S.seen[var] || S.level[var] == 0)
+        continue;
+      S.seen[var] = 1;
+      bump(S, static_cast<int>(var));
+      if (S.level[var] >= decisionlevel(S))
+        counter++;
+      else
+        learnt.push_back(c[k]);
+    }
+
+    while (!S.seen[static_cast<size_t>(S.trail[--index] >> 1)])
+      ;
+    p = S.trail[index];
+    ci = S.reason[static_cast<size_t>(p >> 1)];
+    S.seen[static_cast<size_t>(p >> 1)] = 0;
+    counter--;
+  } while (counter > 0);
+  learnt[0] = p ^ 1;
+
+  int level = 0;
+  for (size_t k = 1; k < learnt.size(); k++) {
+    size_t var = static_cast<size_t>(learnt[k] >> 1);
+    S.seen[var] = 0;
+    if (S.level[var] > level) { // the second watch is of the highest level
+      level = S.level[var];
+      std::swap(learnt[1], learnt[k]);
+    }
+  }
+
+  return level;
+}
+
+static int attach(Solver &S, std::vector<int> lits) {
+  int ci = static_cast<int>(S.clauses.size());
+  S.watches[static_cast<size_t>(lits[0])].push_back(ci);
+  S.watches[static_cast<size_t>(lits[1])].push_back(ci);
+  S.clauses.push_back(std::move(lits));
+  return ci;
+}
+
+int addclause(Solver &S, std::vector<int> lits) {
+  if (S.unsat)
+    return 0;
+  backtrack(S, 0);
+
+  // the literals that are false at level 0 are left out
+  std::sort(lits.begin(), lits.end());
+  lits.erase(std::unique(lits.begin(), lits.end()), lits.end());
+  size_t j = 0;
+  for (size_t i = 0; i < lits.size(); i++) {
+    if (litvalue(S, lits[i]) == 1 ||
+        (i + 1 < lits.size() && lits[i + 1] == (lits[i] ^ 1)))
+      return 1; // the clause is satisfied or a tautology
+    if (litvalue(S, lits[i]) < 0)
+      lits[j++] = lits[i];
+  }
+  lits.resize(j);
+
+  if (lits.empty()) {
+    S.unsat = 1;
+    return 0;
+  }
+  if (lits.size() == 1) {
+    enqueue(S, lits[0], -1);
+    if (propagate(S) >= 0)
+      S.unsat = 1;
+    return !S.unsat;
+  }
+  attach(S, std::move(lits));
+  return 1;
+}
+
+// the i-th element of the Luby sequence 1, 1, 2, 1, 1, 2, 4, ...
+static unsigned long long luby(unsigned long long i) {
+  unsigned long long size = 1, power = 1;
+  while (size < i + 1) {
+    size = 2 * size + 1;
+    power *= 2;
+  }
+  while (size - 1 != i) {
+    size = (size - 1) / 2;
+    power /= 2;
+    i %= size;
+  }
+  return power;
+}
+
+int solve(Solver &S) {
+  if (S.unsat)
+    return 0;
+  backtrack(S, 0);
+
+  std::vector<int> learnt;
+  unsigned long long restarts = 0, budget = 100 * luby(0), since = 0;
+
+  for (;;) {
+    int conflict = propagate(S);
+
+    if (conflict >= 0) {
+      S.conflicts++;
+      since++;
+      if (decisionlevel(S) == 0) {
+        S.unsat = 1;
+        return 0;
+      }
+
+      int level = analyze(S, conflict, learnt);
+      backtrack(S, level);
+      if (learnt.size() == 1)
+        enqueue(S, learnt[0], -1);
+      else
+        enqueue(S, learnt[0], attach(S, learnt));
+      S.var_inc /= 0.95;
+      continue;
+    }
+
+    if (since >= budget) { // restart
+      since = 0;
+      budget = 100 * luby(++restarts);
+      backtrack(S, 0);
+      continue;
+    }
+
+    int var = -1;
+    while (!S.heap.empty()) {
+      int v = heappop(S);
+      if (S.value[static_cast<size_t>(v)] < 0) {
+        var = v;
+        break;
+      }
+    }
+    if (var < 0) // all variables are assigned
+      return 1;
+
+    S.decisions++;
+    S.trail_lim.push_back(S.trail.size());
+    enqueue(S, literal(var, S.phase[static_cast<size_t>(var)]), -1);
+  }
+}
+
+int modelvalue(const Solver &S, int var) {
+  return S.value[static_cast<size_t>(var)] == 1;
+}
@@ -0,0 +1,56 @@
+#ifndef CDCL_H
+#define CDCL_H
+
+#include <stddef.h>
+#include <vector>
+
+// A small conflict-driven clause-learning SAT solver, used by fixed_points.cpp
+// to enumerate the fixed chirotopes as the models of a Boolean formula.
+//
+// The variables are 0, 1, ..., the literal of the variable v is 2v if it is
+// true and 2v+1 if it is false. The solver watches two literals per clause,
+// learns one clause per conflict (first unique implication point), chooses
+// the variable with the highest activity (VSIDS) with its last value, and
+// restarts after a Luby sequence of conflicts. The learnt clauses are kept,
+// so when all models are enumerated by adding a clause that blocks each
+// model, the later searches profit from the earlier ones.
+
+struct Solver {
+  int nr_vars = 0;
+  int unsat = 0; // the clauses are known to be unsatisfiable
+
+  std::vector<std::vector<int>> clauses; // the first two literals are watched
+  std::vector<std::vector<int>> watches; // for every literal its clauses
+
+  std::vector<signed char> value; // for every variable, -1 if not assigned
+  std::vector<int> level;         // the decision level of the assignment
+  std::vector<int> reason;        // the clause that implied it, or -1
+  std::vector<int> trail;         // the assigned literals in their order
+  std::vector<size_t> trail_lim;  // where each decision level starts
+  size_t qhead = 0;               // the literals before it are propagated
+
+  std::vector<double> activity;
+  double var_inc = 1;
+  std::vector<signed char> phase; // the last value of every variable
+  std::vector<int> heap;          // the unassigned variables by activity
+  std::vector<int> heap_index;    // the place in the heap, or -1
+
+  std::vector<signed char> seen;
+  unsigned long long conflicts = 0, decisions = 0;
+};
+
+inline int literal(int var, int positive) { return 2 * var + (positive ? 0 : 1); }
+
+int newvar(Solver &S);
+
+// adds a clause after taking back all decisions; returns 0 if the clauses
+// are unsatisfiable
+int addclause(Solver &S, std::vector<int> lits);
+
+// returns 1 if the clauses are satisfiable, then modelvalue() gives the
+// model, and 0 if they are not
+int solve(Solver &S);
+
+int modelvalue(const Solver &S, int var);
+
+#endif // CDCL_H
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <string.h>
+
+#include "compact.h"
+
+static const char compact_magic[8] = {'M', 'A', 'C', 'P', 'F', 'I', 'X', '1'};
+
+size_t recordsize(const CompactTable &T) {
+  return 1 + (T.orbitnr + 3) / 4;
+}
+
+int writecompactheader(const CompactTable &T, FILE *out) {
+  std::string args;
+  for (size_t g = 0; g < T.args.size(); g++)
+    args += (g > 0 ? "\n" : "") + T.args[g];
+
+  CompactHeader h;
+  memcpy(h.magic, compact_magic, sizeof(h.magic));
+  h.rank = R;
+  h.elements = N;
+  h.nr_orbits = static_cast<uint32_t>(T.orbitnr);
+  h.nr_twists = static_cast<uint32_t>(T.twistsigns.size());
+  h.order = static_cast<uint64_t>(T.order);
+  h.name_length = static_cast<uint32_t>(T.name.size());
+  h.args_length = static_cast<uint32_t>(args.size());
+
+  if (fwrite(&h, sizeof(h), 1, out) != 1)
+    return 0;
+
+  std::vector<uint16_t> orind(T.orind.begin(), T.orind.end());
+  if (fwrite(orind.data(), sizeof(uint16_t), B, out) != B)
+    return 0;
+  for (const auto &w : T.twistsigns)
+    if (fwrite(w.data(), 1, B, out) != B)
+      return 0;
+  if (fwrite(T.name.data(), 1, T.name.size(), out) != T.name.size() ||
+      fwrite(args.data(), 1, args.size(), out) != args.size())
+    return 0;
+
+  return 1;
+}
+
+int readcompactheader(CompactTable &T, FILE *in) {
+  CompactHeader h;
+
+  if (fread(&h, sizeof(h), 1, in) != 1)
+    return 0;
+  if (memcmp(h.magic, compact_magic, sizeof(h.magic)) != 0 || h.rank != R ||
+      h.elements != N) {
+    fprintf(stderr, "The file was not made for MacP(%d,%d).\n", R, N);
+    return 0;
+  }
+  if (h.nr_orbits > B || h.nr_twists > 256)
+    return 0;
+
+  T.order = static_cast<long long>(h.order);
+  T.orbitnr = h.nr_orbits;
+
+  std::vector<uint16_t> orind(B);
+  if (fread(orind.data(), sizeof(uint16_t), B, in) != B)
+    return 0;
+  T.orind.assign(orind.begin(), orind.end());
+  for (int o : T.orind)
+    if (static_cast<size_t>(o) >= T.orbitnr)
+      return 0;
+
+  T.twistsigns.resize(h.nr_twists);
+  for (auto &w : T.twistsigns)
+    if (fread(w.data(), 1, B, in) != B)
+      return 0;
+
+  T.name.resize(h.name_length);
+  std::string args(h.args_length, '\0');
+  if (fread(T.name.data(), 1, T.name.size(), in) != T.name.size() ||
+      fread(args.data(), 1, args.size(), in) != args.size())
+    return 0;
+  T.args.clear();
+  for (size_t begin = 0, end; begin < args.size(); begin = end + 1) {
+    end = std::min(args.find('\n', begin), args.size());
+    T.args.push_back(args.substr(begin, end - begin));
+  }
+
+  return 1;
+}
+
+static int sign(const OM &M, int b) {
+  return (M.plus[b >> 5] >> (b & 31) & 1)    ? 1
+         : (M.minus[b >> 5] >> (b & 31) & 1) ? -1
+                                             : 0;
+}
+
+// the record of M: for every twist the signs of the orbits are read off the
+// first basis of every orbit, and the twist is taken if the other bases have
+// the signs it gives them
+int writecompactOM(const CompactTable &T, const OM &M, FILE *out) {
+  std::vector<unsigned char> record(recordsize(T));
+  std::vector<signed char> s(T.orbitnr);
+
+  for (size_t c = 0; c < T.twistsigns.size(); c++) {
+    const auto &w = T.twistsigns[c];
+    std::vector<char> seen(T.orbitnr, 0);
+    int good = 1;
+    for (int b = 0; b < B && good; b++) {
+      size_t o = static_cast<size_t>(T.orind[static_cast<size_t>(b)]);
+      int x = sign(M, b) * w[static_cast<size_t>(b)];
+      if (!seen[o]) {
+        seen[o] = 1;
+        s[o] = static_cast<signed char>(x);
+      } else if (x != s[o]) // M is not of this twist
+        good = 0;
+    }
+    if (!good)
+      continue;
+
+    record.assign(record.size(), 0);
+    record[0] = static_cast<unsigned char>(c);
+    for (size_t o = 0; o < s.size(); o++)
+      if (s[o] != 0)
+        record[1 + o / 4] |=
+            static_cast<unsigned char>((s[o] > 0 ? 1 : 2) << (2 * (o % 4)));
+    return fwrite(record.data(), 1, record.size(), out) == record.size();
+  }
+
+  return 0;
+}
+
+int readcompactOM(const CompactTable &T, OM &M, FILE *in) {
+  std::vector<unsigned char> record(recordsize(T));
+
+  if (fread(record.data(), 1, record.size(), in) != record.size())
+    return 0;
+  if (record[0] >= T.twistsigns.size()) {
+    fprintf(stderr, "The file has a broken record.\n");
+    return 0;
+  }
+
+  const auto &w = T.twistsigns[record[0]];
+  M = OM();
+  for (int b = 0; b < B; b++) {
+    size_t o = static_cast<size_t>(T.orind[static_cast<size_t>(b)]);
+    int x = record[1 + o / 4] >> (2 * (o % 4)) & 3;
+    int y = (x == 1 ? 1 : x == 2 ? -1 : 0) * w[static_cast<size_t>(b)];
+    if (y > 0)
+      M.plus[b >> 5] |= 1u << (b & 31);
+    else if (y < 0)
+      M.minus[b >> 5] |= 1u << (b & 31);
+  }
+
+  return 1;
+}
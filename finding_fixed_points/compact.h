@@ -0,0 +1,61 @@
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include <array>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "OMs.h"
+
+// A compact file of the oriented matroids that are fixed under a group. Every
+// fixed oriented matroid is made by construct() in fixed_points.cpp from the
+// signs of the orbits of the bases and a twist, so the orbits and the signs
+// of the twists are written once after the header, and every oriented matroid
+// only as its record: one byte for the twist, then two bits for every orbit
+// (0 for zero, 1 for +, 2 for -), four orbits to a byte. The records follow
+// each other up to the end of the file, so they can be written and read one
+// at a time.
+struct CompactTable {
+  std::string name;              // the name of the group
+  std::vector<std::string> args; // its generators as they were given
+  long long order;
+  size_t orbitnr;
+  std::vector<int> orind; // for every basis the orbit it is in
+  // twistsigns[c][b] is the sign of the basis b in a positive orbit for the
+  // twist c
+  std::vector<std::array<signed char, B>> twistsigns;
+};
+
+// the header of a .fom file, followed by orind (uint16_t), twistsigns, the
+// name, the generators separated by newlines and the records
+struct CompactHeader {
+  char magic[8]; // "MACPFIX1"
+  uint32_t rank;
+  uint32_t elements;
+  uint32_t nr_orbits;
+  uint32_t nr_twists;
+  uint64_t order;
+  uint32_t name_length;
+  uint32_t args_length;
+};
+
+// the number of bytes of a record
+size_t recordsize(const CompactTable &T);
+
+// writes the header and the tables, returns 0 if writing failed
+int writecompactheader(const CompactTable &T, FILE *out);
+
+// reads the header and the tables of a file written for the same R and N,
+// returns 0 on failure
+int readcompactheader(CompactTable &T, FILE *in);
+
+// writes the record of M, returns 0 if M has none (it is not one of the
+// oriented matroids of the table) or writing failed
+int writecompactOM(const CompactTable &T, const OM &M, FILE *out);
+
+// reads the next record and expands it to M, returns 0 at the end of file
+int readcompactOM(const CompactTable &T, OM &M, FILE *in);
+
+#endif // COMPACT_H
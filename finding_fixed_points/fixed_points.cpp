@@ -0,0 +1,1211 @@
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "OMs.h"
+#include "cdcl.h"
+#include "compact.h"
+#include "groups.h"
+#include "propagate.h"
+#include "queue.h"
+#include "stats.h"
+
+// This program finds all oriented matroids of rank R on N elements that are
+// fixed under the action of a group, given by generating permutations in
+// cycle notation, e.g. (1,2,3)(4,5,6). It does in one process what short_l.c,
+// longer_l.c and construct_fixed_OMs.c do with text files in between. A
+// group element can also reorient elements after permuting them, e.g.
+// (1,2,3)(4,5,6)-1 (see readgroup() in groups.h); the reorientation only
+// changes the signs of the bases in the orbits, so the search below is the
+// same for such signed permutations.
+//
+// The bases are split into orbits under the group. A list l says which orbits
+// are nonzero. First all prefixes of l of length size that pass ispossible()
+// are made (short_l.c), then every prefix is extended to all of the orbits
+// (longer_l.c), and for every full list all signs of the orbits and the
+// twists of the signs within the orbits are tried (construct_fixed_OMs.c),
+// where only the twists that come from sign characters of the group and are
+// compatible with every nonzero orbit are left (see maketwists()).
+// Below the prefixes, the lists and the signs of the orbits are found by
+// constraint propagation (see propagate.h), so that only the candidates that
+// satisfy Axiom B2' and the three-term Grassmann-Pluecker relations on the
+// orbits reach isinvariantchirotope(), which checks Axiom B2' on one pair
+// of bases of every orbit of pairs. With --dump the lists are also written
+// to the files of short_l.c and longer_l.c.
+//
+// With --sat the search below a prefix is instead done by the SAT solver of
+// cdcl.h: the fixed chirotopes are the models of a formula (see encode())
+// that are accepted by isinvariantchirotope(), and all models are enumerated
+// by blocking each one found. Only the lists with a model are seen then, so
+// --dump cannot be used with --sat.
+//
+// The prefixes are independent, so they are handed to a pool of threads,
+// each of which does the whole search below a prefix. Every thread takes the
+// prefixes from its own deque and steals from the deques of the others when
+// it runs out. Without -l the length of the prefixes is chosen from a sample
+// of the work below them (see choosedepth()). The results are written in the
+// order of the prefixes, so the output is the same for any number of threads
+// and any length of the prefixes.
+//
+// With --sweep the groups of a file are done in one run (see sweep()): if H
+// is a subgroup of G, then Fix(G) is contained in Fix(H), so only the groups
+// without a subgroup in the file are searched, and the fixed points of the
+// others are the fixed points of their largest subgroup that are also fixed
+// by the remaining generators.
+//
+// With --compact the fixed oriented matroids are written to a .fom file of
+// compact.h, one record of the signs of the orbits and the twist for each,
+// about |G| times smaller than the text file. --compress makes such a file
+// from a text file of the same group, and --expand makes the text file again.
+
+using Signs = std::vector<signed char>;
+
+// everything the search knows about one group, made by makecontext() and
+// only read afterwards: the threads of a search share one context, and
+// searches for different groups can run side by side
+struct Context {
+  GroupAction action;
+  int sizeofgroup;  // the order of the group
+  int orbitnr;      // the number of orbits
+  int size;         // the length of the prefixes
+  int reserved = 0; // keeps the struct free of padding
+
+  // orbits[i][k] is the image of the first basis of the i-th orbit under the
+  // k-th element of the group, orbitsigns[i][k] the sign of that permutation
+  // of the basis
+  std::vector<std::vector<int>> orbits;
+  std::vector<std::vector<signed char>> orbitsigns;
+  std::vector<int> orind; // for every basis the orbit it is in
+
+  std::vector<Pair> pairs;
+  std::vector<std::vector<int>> checks; // the pairs that depend on orbit i
+  Constraints constraints;
+
+  // the twists that can give fixed oriented matroids, from the largest down
+  // (see maketwists()): the bit k of twists[c] is set if the signs of the
+  // k-th bases of the orbits change; compatible[o] has the bit c set if
+  // twists[c] gives no contradiction within the orbit o, twistsigns[c][b] is
+  // then the sign of the basis b in a positive orbit, and orbitoms[o][c] the
+  // orbit o as a positive orbit
+  std::vector<long long> twists;
+  std::vector<unsigned long long> compatible;
+  std::vector<std::array<signed char, B>> twistsigns;
+  std::vector<std::vector<OM>> orbitoms;
+
+  // one pair of bases of every orbit of pairs, see makeorbitpairs()
+  std::vector<std::array<int, 2>> orbitpairs;
+};
+
+// the work below one prefix, handed from the threads to the writer
+struct Result {
+  size_t index = 0;         // the number of the prefix
+  long long nr_lists = 0;   // the number of full lists below the prefix
+  std::vector<Signs> lists; // these lists, only with --dump
+  std::vector<OM> fixed;    // the fixed oriented matroids below the prefix
+};
+
+// the prefixes of one thread
+struct Worker {
+  std::mutex m;
+  std::deque<size_t> tasks;
+};
+
+// the action of a signed permutation on the bases: the basis b is mapped to
+// image[b], and sign[b] is the sign of the permutation that sorts it times
+// -1 for every reoriented element of image[b]
+struct BasisAction {
+  std::array<int, B> image;
+  std::array<int, B> sign;
+};
+
+// the actions of the permutations on the bases that are made so far, kept for
+// all groups of a sweep
+using ActionCache = std::map<SignedPermutation, BasisAction>;
+
+// the action of g on the bases, made once for every signed permutation
+static const BasisAction &basisaction(ActionCache &actions,
+                                      const SignedPermutation &g) {
+  auto it = actions.find(g);
+  if (it != actions.end())
+    return it->second;
+
+  BasisAction &A = actions[g];
+  for (size_t b = 0; b < B; b++) {
+    std::array<unsigned char, R> x;
+    for (size_t j = 0; j < R; j++)
+      x[j] = g.p[bases[b, j]];
+    auto [y, sign] = sort(x);
+    for (size_t j = 0; j < R; j++)
+      if (g.reoriented >> y[j] & 1)
+        sign = static_cast<char>(-sign);
+    A.image[b] = ind(y);
+    A.sign[b] = sign;
+  }
+  return A;
+}
+
+// makes for every basis all its images under the group action, every orbit is
+// stored once
+static void makeorbits(Context &C, ActionCache &actions) {
+  C.orbits.clear();
+  C.orbitsigns.clear();
+  C.orind.assign(B, -1);
+  C.orbitnr = 0;
+
+  for (int b = 0; b < B; b++) {
+    if (C.orind[static_cast<size_t>(b)] >= 0) // we already have its orbit
+      continue;
+
+    C.orbits.emplace_back(C.sizeofgroup);
+    C.orbitsigns.emplace_back(C.sizeofgroup);
+
+    for (int k = 0; k < C.sizeofgroup; k++) {
+      const BasisAction &A =
+          basisaction(actions, C.action.elements[static_cast<size_t>(k)]);
+      int c = A.image[static_cast<size_t>(b)];
+
+      C.orbits.back()[static_cast<size_t>(k)] = c;
+      C.orbitsigns.back()[static_cast<size_t>(k)] =
+          static_cast<signed char>(A.sign[static_cast<size_t>(b)]);
+      C.orind[static_cast<size_t>(c)] = C.orbitnr;
+    }
+
+    C.orbitnr++;
+  }
+}
+
+// makes orbitpairs: the candidates are fixed up to sign, so the pairs of
+// bases that fail Axiom B2' are a union of orbits of the ordered pairs under
+// the group, and one pair (a, b), a < b, of every orbit that has one is
+// enough for isinvariantchirotope()
+static void makeorbitpairs(Context &C, ActionCache &actions) {
+  std::vector<const BasisAction *> images;
+  for (const SignedPermutation &g : C.action.elements)
+    images.push_back(&basisaction(actions, g));
+
+  C.orbitpairs.clear();
+  std::vector<char> seen(B * B, 0);
+  for (int a = 0; a < B; a++)
+    for (int b = a + 1; b < B; b++) {
+      if (seen[static_cast<size_t>(a * B + b)])
+        continue;
+      C.orbitpairs.push_back({a, b});
+      for (const BasisAction *A : images)
+        seen[static_cast<size_t>(A->image[static_cast<size_t>(a)] * B +
+                                 A->image[static_cast<size_t>(b)])] = 1;
+    }
+}
+
+// checks the pairs that depend on the orbit i after l[i] is made, all pairs
+// that do not depend on it were checked before; the list l of length i+1 can
+// be extended to a full list only if this holds for all of its entries
+static int ispossible(const Context &C, const signed char *l, int i) {
+  for (int c : C.checks[static_cast<size_t>(i)]) {
+    const Pair &P = C.pairs[static_cast<size_t>(c)];
+    if (l[P.o1] && l[P.o2] && isgood(P, l, i + 1) == 0)
+      return 0;
+  }
+
+  return 1;
+}
+
+// makes the entries i,...,z-1 of l and calls leaf for every l that passes
+// ispossible() at every entry, the entries before i have passed it already
+template <class F>
+static void makepossible(const Context &C, Signs &l, int i, int z, F &leaf) {
+  if (i == z) {
+    leaf(l);
+    return;
+  }
+
+  for (signed char x = 0; x <= 1; x++) {
+    l[static_cast<size_t>(i)] = x;
+    if (ispossible(C, l.data(), i))
+      makepossible(C, l, i + 1, z, leaf);
+  }
+}
+
+// makes the twists that can give fixed oriented matroids: if M is fixed, then
+// g(M) = e(g) M for a sign character e of the group, so the signs of the
+// k-th bases of the orbits change by +-e(g_k) (the sign is the same for all
+// k). With the last bit 0 as in construct_fixed_OMs.c this leaves one twist
+// per character instead of all 2^(sizeofgroup-1). The characters are found
+// from their values on a minimal set of generators.
+static void maketwists(Context &C) {
+  const std::vector<SignedPermutation> &generators = C.action.generators;
+  size_t nr_generators = generators.size();
+  C.twists.clear();
+  for (unsigned long long v = 0; v < 1ull << nr_generators; v++) {
+    std::vector<int> e(static_cast<size_t>(C.sizeofgroup), 0);
+    std::vector<int> queue = {0}; // the identity
+    e[0] = 1;
+    int good = 1;
+
+    for (size_t q = 0; q < queue.size() && good; q++) {
+      const SignedPermutation &g =
+          C.action.elements[static_cast<size_t>(queue[q])];
+      for (size_t i = 0; i < nr_generators && good; i++) {
+        size_t h = static_cast<size_t>(
+            groupindex(C.action, compose(g, generators[i])));
+        int value = e[static_cast<size_t>(queue[q])] * ((v >> i & 1) ? -1 : 1);
+        if (e[h] == 0) {
+          e[h] = value;
+          queue.push_back(static_cast<int>(h));
+        } else if (e[h] != value) // this is not a character
+          good = 0;
+      }
+    }
+    if (!good)
+      continue;
+
+    long long x = 0;
+    for (int k = 0; k < C.sizeofgroup; k++)
+      if (e[static_cast<size_t>(k)] !=
+          e[static_cast<size_t>(C.sizeofgroup - 1)])
+        x |= 1ll << k;
+    C.twists.push_back(x);
+  }
+
+  std::sort(C.twists.begin(), C.twists.end(), std::greater<long long>());
+  C.twists.erase(std::unique(C.twists.begin(), C.twists.end()),
+                 C.twists.end());
+
+  // the signs of the bases, checked within every orbit, and the orbits as
+  // positive orbits
+  C.compatible.assign(static_cast<size_t>(C.orbitnr), 0);
+  C.twistsigns.assign(C.twists.size(), {});
+  C.orbitoms.assign(static_cast<size_t>(C.orbitnr),
+                    std::vector<OM>(C.twists.size()));
+  for (size_t c = 0; c < C.twists.size(); c++) {
+    auto &w = C.twistsigns[c];
+    for (int o = 0; o < C.orbitnr; o++) {
+      int good = 1;
+      OM &M = C.orbitoms[static_cast<size_t>(o)][c];
+      for (int k = 0; k < C.sizeofgroup; k++) {
+        int b = C.orbits[static_cast<size_t>(o)][static_cast<size_t>(k)];
+        int s = C.orbitsigns[static_cast<size_t>(o)][static_cast<size_t>(k)] *
+                ((C.twists[c] >> k & 1) ? -1 : 1);
+        if (w[static_cast<size_t>(b)] == 0) {
+          w[static_cast<size_t>(b)] = static_cast<signed char>(s);
+          if (s > 0)
+            M.plus[b >> 5] |= 1u << (b & 31);
+          else
+            M.minus[b >> 5] |= 1u << (b & 31);
+        } else if (w[static_cast<size_t>(b)] != s) // contradiction within
+          good = 0;                                // the same orbit
+      }
+      if (good)
+        C.compatible[static_cast<size_t>(o)] |= 1ull << c;
+    }
+  }
+}
+
+// the oriented matroid with the signs s of the orbits and the twist c
+static OM construct(const Context &C, const Signs &s, size_t c) {
+  OM M;
+  for (int o = 0; o < C.orbitnr; o++) {
+    int sign = s[static_cast<size_t>(o)];
+    if (sign == 0)
+      continue;
+    const OM &X = C.orbitoms[static_cast<size_t>(o)][c];
+    for (int i = 0; i < nr_ints; i++) {
+      M.plus[i] |= sign > 0 ? X.plus[i] : X.minus[i];
+      M.minus[i] |= sign > 0 ? X.minus[i] : X.plus[i];
+    }
+  }
+  return M;
+}
+
+// tries all signs of the nonzero orbits (the last one is positive) and all
+// twists that are compatible with every nonzero orbit; the signs of the
+// orbits are found by signvectors() for every twist, the fixed oriented
+// matroids are then put in the order of construct_fixed_OMs.c: the signs y of
+// the orbits from the largest down, and for every y the twists x from the
+// largest down
+static void constructall(const Context &C, const Signs &l,
+                         std::vector<OM> &fixed) {
+  std::vector<int> used;
+  for (int i = 0; i < C.orbitnr; i++)
+    if (l[static_cast<size_t>(i)])
+      used.push_back(i);
+
+  if (used.empty())
+    return;
+
+  struct Found {
+    long long y, x;
+    OM M;
+  };
+  std::vector<Found> found;
+  std::vector<Signs> signs;
+
+  unsigned long long possible = ~0ull;
+  for (int o : used)
+    possible &= C.compatible[static_cast<size_t>(o)];
+
+  for (size_t c = 0; c < C.twists.size(); c++) {
+    if ((possible >> c & 1) == 0)
+      continue;
+
+    signs.clear();
+    signvectors(C.constraints, l.data(), C.twistsigns[c].data(), signs);
+    for (const Signs &s : signs) {
+      OM M = construct(C, s, c);
+      if (isinvariantchirotope(M, C.orbitpairs)) {
+        long long y = 0;
+        for (size_t i = 0; i + 1 < used.size(); i++)
+          if (s[static_cast<size_t>(used[i])] < 0)
+            y |= 1ll << i;
+        standardizeOM(&M);
+        found.push_back({y, C.twists[c], M});
+      }
+    }
+  }
+
+  std::sort(found.begin(), found.end(), [](const Found &a, const Found &b) {
+    return a.y != b.y ? a.y > b.y : a.x > b.x;
+  });
+  for (const Found &f : found)
+    fixed.push_back(f.M);
+}
+
+// all prefixes of length d that pass ispossible()
+static std::vector<Signs> makeprefixes(const Context &C, int d) {
+  std::vector<Signs> prefixes;
+  Signs l(static_cast<size_t>(d));
+  auto leaf = [&](const Signs &prefix) { prefixes.push_back(prefix); };
+  makepossible(C, l, 0, d, leaf);
+  return prefixes;
+}
+
+// the number of lists of length z that extend the prefix l
+static long long extensions(const Context &C, Signs l, int z) {
+  int d = static_cast<int>(l.size());
+  long long n = 0;
+  auto leaf = [&](const Signs &) { n++; };
+  l.resize(static_cast<size_t>(z));
+  makepossible(C, l, d, z, leaf);
+  return n;
+}
+
+// chooses the length of the prefixes: they are made longer until there are
+// enough of them for the threads and none of a sample of them has much more
+// work below it than the average; the work below a prefix is estimated by
+// the number of its extensions by a few more orbits
+static int choosedepth(const Context &C, unsigned int nr_threads) {
+  std::mt19937 rng(1); // the same choice in every run
+  const int nr_samples = 16;
+
+  for (int d = 1; d < C.orbitnr; d++) {
+    std::vector<Signs> prefixes = makeprefixes(C, d);
+    if (prefixes.size() >= 1024 * nr_threads)
+      return d;
+    if (prefixes.size() < 16 * nr_threads)
+      continue;
+
+    int z = std::min(C.orbitnr, d + 6);
+    long long sum = 0, max = 0;
+    for (int k = 0; k < nr_samples; k++) {
+      long long n = extensions(C, prefixes[rng() % prefixes.size()], z);
+      sum += n;
+      max = std::max(max, n);
+    }
+    if (max * nr_samples <= 4 * sum) // at most 4 times the average
+      return d;
+  }
+
+  return C.orbitnr;
+}
+
+// the search below the prefix: the other orbits are found with constraint
+// propagation (see propagate.h), the full lists are sorted so that they come
+// in the same order as from makepossible()
+static void search(const Context &C, const Signs &prefix, int dumplists,
+                   Result &res) {
+  ListState S;
+  startlists(C.constraints, S);
+
+  std::vector<Signs> lists;
+  int good = 1;
+  for (size_t i = 0; i < prefix.size() && good; i++)
+    good = setorbit(S, static_cast<int>(i), prefix[i]);
+  if (good)
+    completelists(S, lists);
+
+  res.nr_lists = static_cast<long long>(lists.size());
+  for (const Signs &full : lists) {
+    if (dumplists)
+      res.lists.push_back(full);
+    constructall(C, full, res.fixed);
+  }
+}
+
+// the variables of the formula for the SAT solver: z+o says that the orbit o
+// is nonzero, s+o that it is positive, x+k is the bit k of the twist, and
+// both[{o1, o2}] that both orbits are nonzero
+struct Encoding {
+  std::map<std::pair<int, int>, int> both;
+  int z, s, x;
+  int reserved = 0; // keeps the struct free of padding
+};
+
+// the clauses that say that a ^ b ^ c = r
+static void addxor(Solver &S, int a, int b, int c, int r) {
+  for (int m = 0; m < 8; m++)
+    if (((m ^ (m >> 1) ^ (m >> 2)) & 1) != r) // forbid this assignment
+      addclause(S, {literal(a, !(m & 1)), literal(b, !(m >> 1 & 1)),
+                    literal(c, !(m >> 2 & 1))});
+}
+
+// the variable that says that both orbits are nonzero
+static int bothnonzero(Solver &S, Encoding &E, int o1, int o2) {
+  if (o1 == o2)
+    return E.z + o1;
+  auto key = std::make_pair(std::min(o1, o2), std::max(o1, o2));
+  auto it = E.both.find(key);
+  if (it != E.both.end())
+    return it->second;
+
+  int a = newvar(S);
+  addclause(S, {literal(a, 0), literal(E.z + o1, 1)});
+  addclause(S, {literal(a, 0), literal(E.z + o2, 1)});
+  addclause(S, {literal(a, 1), literal(E.z + o1, 0), literal(E.z + o2, 0)});
+  E.both.emplace(key, a);
+  return a;
+}
+
+// the formula whose models are the candidates of construct_fixed_OMs.c below
+// the prefix that satisfy the constraints of propagate.h:
+// - the orbits of the prefix are as given, some orbit is nonzero, the last
+//   nonzero orbit is positive, the zero orbits count as positive and the
+//   twist is one of twists,
+// - c_b says that the basis b is positive: c_b ^ s_o ^ x_k = 1 if the k-th
+//   basis of the orbit o is b and orbitsigns[o][k] is negative, else 0; if
+//   b is also the k'-th basis, x_k and x_k' must fit,
+// - every exchange is a clause,
+// - for every relation, p_t says that the t-th product is negative, and the
+//   nonzero products are not all equal
+static Encoding encode(const Context &C, Solver &S, const Signs &prefix) {
+  Encoding E;
+  E.z = S.nr_vars;
+  for (int o = 0; o < 2 * C.orbitnr; o++)
+    newvar(S);
+  E.s = E.z + C.orbitnr;
+  E.x = S.nr_vars;
+  for (int k = 0; k < C.sizeofgroup; k++)
+    newvar(S);
+
+  for (size_t o = 0; o < prefix.size(); o++)
+    addclause(S, {literal(E.z + static_cast<int>(o), prefix[o])});
+  std::vector<int> any;
+  for (long long x : C.twists) {
+    int q = newvar(S);
+    any.push_back(literal(q, 1));
+    for (int k = 0; k < C.sizeofgroup; k++)
+      addclause(S, {literal(q, 0), literal(E.x + k, x >> k & 1)});
+  }
+  addclause(S, any);
+
+  std::vector<int> some;
+  for (int o = 0; o < C.orbitnr; o++) {
+    some.push_back(literal(E.z + o, 1));
+    addclause(S, {literal(E.z + o, 1), literal(E.s + o, 1)});
+
+    std::vector<int> last = {literal(E.z + o, 0), literal(E.s + o, 1)};
+    for (int p = o + 1; p < C.orbitnr; p++)
+      last.push_back(literal(E.z + p, 1));
+    addclause(S, last);
+  }
+  addclause(S, some);
+
+  std::vector<int> c(B, -1), place(B), firstsign(B); // e at place[b]
+  for (int o = 0; o < C.orbitnr; o++)
+    for (int k = 0; k < C.sizeofgroup; k++) {
+      int b = C.orbits[static_cast<size_t>(o)][static_cast<size_t>(k)];
+      int e = C.orbitsigns[static_cast<size_t>(o)][static_cast<size_t>(k)] < 0;
+      if (c[static_cast<size_t>(b)] < 0) {
+        c[static_cast<size_t>(b)] = newvar(S);
+        place[static_cast<size_t>(b)] = k;
+        firstsign[static_cast<size_t>(b)] = e;
+        addxor(S, c[static_cast<size_t>(b)], E.s + o, E.x + k, e);
+        continue;
+      }
+
+      int k0 = place[static_cast<size_t>(b)];
+      int r = e ^ firstsign[static_cast<size_t>(b)];
+      for (int m = 0; m < 4; m++)
+        if (((m ^ (m >> 1)) & 1) != r)
+          addclause(S, {literal(E.z + o, 0), literal(E.x + k0, !(m & 1)),
+                        literal(E.x + k, !(m >> 1 & 1))});
+    }
+
+  for (const Exchange &X : C.constraints.exchanges) {
+    std::vector<int> clause = {literal(E.z + X.o1, 0), literal(E.z + X.o2, 0)};
+    for (int w = X.begin; w < X.end; w++) {
+      const auto &t = C.constraints.witnesses[static_cast<size_t>(w)];
+      clause.push_back(literal(bothnonzero(S, E, t[0], t[1]), 1));
+    }
+    addclause(S, clause);
+  }
+
+  for (const Relation &rel : C.constraints.relations) {
+    int n[3], p[3];
+    for (int t = 0; t < 3; t++) {
+      int b0 = rel.bases[t][0], b1 = rel.bases[t][1];
+      n[t] = bothnonzero(S, E, C.orind[static_cast<size_t>(b0)],
+                         C.orind[static_cast<size_t>(b1)]);
+      p[t] = newvar(S);
+      addxor(S, p[t], c[static_cast<size_t>(b0)], c[static_cast<size_t>(b1)],
+             rel.sign[t] < 0);
+    }
+
+    for (int v = 0; v <= 1; v++) // not all three are equal
+      addclause(S, {literal(n[0], 0), literal(n[1], 0), literal(n[2], 0),
+                    literal(p[0], v), literal(p[1], v), literal(p[2], v)});
+    for (int i = 0; i < 3; i++) { // the other two are different
+      int j = (i + 1) % 3, k = (i + 2) % 3;
+      for (int v = 0; v <= 1; v++)
+        addclause(S, {literal(n[j], 0), literal(n[k], 0), literal(n[i], 1),
+                      literal(p[j], v), literal(p[k], v)});
+    }
+  }
+
+  return E;
+}
+
+// the search below the prefix with the SAT solver, the results are sorted
+// into the order of search()
+static void searchsat(const Context &C, const Signs &prefix, Result &res) {
+  Solver S;
+  Encoding E = encode(C, S, prefix);
+
+  struct Found {
+    Signs l;
+    long long y, x;
+    OM M;
+  };
+  std::vector<Found> found;
+  std::set<Signs> lists;
+  Signs l(static_cast<size_t>(C.orbitnr)), s(static_cast<size_t>(C.orbitnr));
+  std::vector<int> block;
+
+  while (solve(S)) {
+    long long x = 0;
+    for (int k = 0; k < C.sizeofgroup; k++)
+      if (modelvalue(S, E.x + k))
+        x |= 1ll << k;
+    std::vector<int> used;
+    for (int o = 0; o < C.orbitnr; o++) {
+      l[static_cast<size_t>(o)] =
+          static_cast<signed char>(modelvalue(S, E.z + o));
+      s[static_cast<size_t>(o)] = static_cast<signed char>(
+          l[static_cast<size_t>(o)] ? (modelvalue(S, E.s + o) ? 1 : -1) : 0);
+      if (l[static_cast<size_t>(o)])
+        used.push_back(o);
+    }
+    lists.insert(l);
+
+    size_t c = static_cast<size_t>(
+        std::find(C.twists.begin(), C.twists.end(), x) - C.twists.begin());
+    if (C.compatible[static_cast<size_t>(used.back())] >> c & 1) {
+      OM M = construct(C, s, c);
+      if (isinvariantchirotope(M, C.orbitpairs)) {
+        long long y = 0;
+        for (size_t i = 0; i + 1 < used.size(); i++)
+          if (s[static_cast<size_t>(used[i])] < 0)
+            y |= 1ll << i;
+        standardizeOM(&M);
+        found.push_back({l, y, x, M});
+      }
+    }
+
+    // the next model differs in a nonzero orbit, a sign or the twist
+    block.clear();
+    for (int v = E.z; v < E.x + C.sizeofgroup; v++)
+      block.push_back(literal(v, !modelvalue(S, v)));
+    if (addclause(S, block) == 0)
+      break;
+  }
+
+  res.nr_lists = static_cast<long long>(lists.size());
+
+  std::sort(found.begin(), found.end(), [](const Found &a, const Found &b) {
+    if (a.l != b.l)
+      return a.l < b.l;
+    return a.y != b.y ? a.y > b.y : a.x > b.x;
+  });
+  for (const Found &f : found)
+    res.fixed.push_back(f.M);
+}
+
+// the next prefix for the thread t, from the front of its own deque or from
+// the back of the deque of another thread; returns 0 if there is none left
+static int nexttask(std::vector<Worker> &workers, size_t t, size_t &task) {
+  for (size_t k = 0; k < workers.size(); k++) {
+    Worker &W = workers[(t + k) % workers.size()];
+    std::lock_guard<std::mutex> lock(W.m);
+    if (W.tasks.empty())
+      continue;
+    if (k == 0) {
+      task = W.tasks.front();
+      W.tasks.pop_front();
+    } else {
+      task = W.tasks.back();
+      W.tasks.pop_back();
+    }
+    return 1;
+  }
+  return 0;
+}
+
+static void dump(FILE *f, const Signs &l) {
+  if (f == NULL)
+    return;
+  for (signed char x : l)
+    fprintf(f, "%2d", x);
+  fputc('\n', f);
+}
+
+static FILE *openfile(const char *name, const char *mode) {
+  FILE *f = fopen(name, mode);
+  if (f == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", name);
+    exit(EXIT_FAILURE);
+  }
+  return f;
+}
+
+// the context of the group generated by the generators: its action, the
+// orbits, the constraints, the twists and the length of the prefixes
+static Context makecontext(const std::vector<SignedPermutation> &generators,
+                           int length, unsigned int nr_threads,
+                           ActionCache &actions) {
+  Context C;
+  C.action = makegroupaction(generators, 63);
+  if (C.action.elements.size() > 63) {
+    fprintf(stderr, "The group has more than 63 elements, at most 63 are "
+                    "possible.\n");
+    exit(EXIT_FAILURE);
+  }
+  C.sizeofgroup = static_cast<int>(C.action.elements.size());
+
+  makeorbits(C, actions);
+  makepairs(C.orbits, C.orind, C.pairs, C.checks);
+  C.constraints = makeconstraints(C.pairs, C.orind, C.orbitnr);
+  maketwists(C);
+  makeorbitpairs(C, actions);
+  C.size = length == 0 ? choosedepth(C, nr_threads) : length;
+  C.size = std::min(C.size, C.orbitnr);
+
+  printf("R=%d, N=%d, B=%d, the group has %d elements, %d orbits, %zu "
+         "twists, prefixes of length %d\n",
+         R, N, B, C.sizeofgroup, C.orbitnr, C.twists.size(), C.size);
+
+  return C;
+}
+
+// the orbits and the signs of the twists of C for a compact file
+static CompactTable maketable(const Context &C, const char *group,
+                              const std::vector<std::string> &args) {
+  CompactTable T;
+  T.name = group;
+  T.args = args;
+  T.order = C.sizeofgroup;
+  T.orbitnr = static_cast<size_t>(C.orbitnr);
+  T.orind = C.orind;
+  T.twistsigns = C.twistsigns;
+  return T;
+}
+
+// opens the output file of the group and writes its header, the compact file
+// of compact.h if compact is not NULL
+static FILE *openoutput(const char *group, long long order,
+                        const std::vector<std::string> &args,
+                        const CompactTable *compact) {
+  char text[300];
+  sprintf(text, "fixed_OMs_rank%d_%delements_group_%s.%s", R, N, group,
+          compact != NULL ? "fom" : "txt");
+  FILE *out = openfile(text, compact != NULL ? "wb" : "w");
+  setvbuf(out, NULL, _IOFBF, 1 << 20); // a buffer of its own for every file
+
+  if (compact != NULL) {
+    if (writecompactheader(*compact, out) == 0) {
+      fprintf(stderr, "Could not write the file %s.\n", text);
+      exit(EXIT_FAILURE);
+    }
+    return out;
+  }
+
+  fprintf(out,
+          "All oriented matroids of rank %d on %d elements that are fixed "
+          "under the action of the group of order %lld generated by",
+          R, N, order);
+  for (size_t g = 0; g < args.size(); g++)
+    fprintf(out, "%s %s", g > 0 ? " and" : "", args[g].c_str());
+  fprintf(out, ".\n\n");
+  if (N < 10) {
+    for (size_t j = 0; j < R; j++) {
+      for (size_t b = 0; b < B; b++)
+        fputc('1' + bases[b, j], out);
+      fputc('\n', out);
+    }
+  } else
+    fprintf(out, "The order of the bases is lexicographical.\n");
+  fputc('\n', out);
+
+  return out;
+}
+
+// the search for the group of C: the prefixes are handed to the threads and
+// the fixed oriented matroids are written to out in the order of the
+// prefixes, as records of compact if it is not NULL, and also kept in fixed
+// if it is not NULL; returns their number
+static long long findfixed(const Context &C, FILE *out,
+                           const CompactTable *compact, FILE *dump_prefixes,
+                           FILE *dump_full, int dumplists, int sat,
+                           unsigned int nr_threads, std::vector<OM> *fixed) {
+  statbegin("fixed points");
+
+  std::vector<Signs> prefixes = makeprefixes(C, C.size);
+  for (const Signs &prefix : prefixes)
+    dump(dump_prefixes, prefix);
+
+  // every thread starts with a block of consecutive prefixes
+  std::vector<Worker> workers(nr_threads);
+  for (size_t p = 0; p < prefixes.size(); p++)
+    workers[p * nr_threads / prefixes.size()].tasks.push_back(p);
+
+  Queue<Result> results(1024);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < nr_threads; t++)
+    threads.emplace_back([&, t] {
+      size_t task;
+      while (nexttask(workers, t, task)) {
+        Result res;
+        res.index = task;
+        if (sat)
+          searchsat(C, prefixes[task], res);
+        else
+          search(C, prefixes[task], dumplists, res);
+        results.push(std::move(res));
+      }
+    });
+
+  // the results are written in the order of the prefixes
+  std::map<size_t, Result> pending;
+  size_t next = 0;
+  long long nr_lists = 0, count = 0;
+  for (size_t done = 0; done < prefixes.size(); done++) {
+    Result res;
+    results.pop(res);
+    size_t index = res.index;
+    pending.emplace(index, std::move(res));
+
+    for (auto it = pending.find(next); it != pending.end();
+         it = pending.find(++next)) {
+      for (const Signs &full : it->second.lists)
+        dump(dump_full, full);
+      for (const OM &M : it->second.fixed)
+        if (compact != NULL)
+          writecompactOM(*compact, M, out);
+        else
+          writeOM(M, out);
+      if (fixed != NULL)
+        fixed->insert(fixed->end(), it->second.fixed.begin(),
+                      it->second.fixed.end());
+      nr_lists += it->second.nr_lists;
+      count += static_cast<long long>(it->second.fixed.size());
+      pending.erase(it);
+    }
+    statprogress(done + 1, prefixes.size());
+  }
+
+  for (auto &t : threads)
+    t.join();
+
+  statend(static_cast<unsigned long long>(nr_lists));
+
+  printf("%zu prefixes of length %d, %lld lists of length %d\n",
+         prefixes.size(), C.size, nr_lists, C.orbitnr);
+
+  return count;
+}
+
+// checks whether the permutation with the basis action A maps M to +-M; it is
+// a bijection of the bases, so it is enough that the nonzero bases are mapped
+// to nonzero bases with the same change of sign
+static int isfixedby(const OM &M, const BasisAction &A) {
+  int change = 0;
+  for (int b = 0; b < B; b++) {
+    int x = (M.plus[b >> 5] >> (b & 31) & 1)    ? 1
+            : (M.minus[b >> 5] >> (b & 31) & 1) ? -1
+                                                : 0;
+    if (x == 0)
+      continue;
+    int c = A.image[static_cast<size_t>(b)];
+    int y = (M.plus[c >> 5] >> (c & 31) & 1)    ? 1
+            : (M.minus[c >> 5] >> (c & 31) & 1) ? -1
+                                                : 0;
+    int s = x * y * A.sign[static_cast<size_t>(b)];
+    if (s == 0 || (change != 0 && s != change))
+      return 0;
+    change = s;
+  }
+  return 1;
+}
+
+// a group of a sweep: if no generator reorients elements, G is the group,
+// else all elements are listed in action
+struct SweepGroup {
+  std::string name;
+  std::vector<std::string> args; // the generators as they are given
+  std::vector<SignedPermutation> generators;
+  Group G;
+  GroupAction action;
+  long long order;
+  std::vector<OM> fixed;
+  int reorients = 0;
+  int done = 0;
+};
+
+// checks whether the signed permutation g is in the group of S
+static int contains(const SweepGroup &S, const SignedPermutation &g) {
+  if (S.reorients == 0)
+    return g.reoriented == 0 && elementnumber(S.G, g.p) >= 0;
+  return groupindex(S.action, g) >= 0;
+}
+
+// reads the groups of a sweep, one per line: the name of the group and its
+// generators as on the command line, e.g. "Z3+Z3 (1,2,3) (4,5,6)"; empty
+// lines and lines that start with # are skipped
+static std::vector<SweepGroup> readsweep(const char *name) {
+  FILE *f = openfile(name, "r");
+  std::vector<SweepGroup> groups;
+  char line[4096];
+  int nr = 0;
+
+  while (fgets(line, sizeof(line), f) != NULL) {
+    nr++;
+    std::vector<std::string> words;
+    for (char *w = strtok(line, " \t\r\n"); w != NULL;
+         w = strtok(NULL, " \t\r\n"))
+      words.push_back(w);
+    if (words.empty() || words[0][0] == '#')
+      continue;
+
+    SweepGroup S;
+    S.name = words[0];
+    S.args.assign(words.begin() + 1, words.end());
+    for (const std::string &w : S.args)
+      if (readgroup(w.c_str(), S.generators) == 0) {
+        fprintf(stderr, "%s, line %d: %s is not a group.\n", name, nr,
+                w.c_str());
+        exit(EXIT_FAILURE);
+      }
+    if (S.generators.empty()) {
+      fprintf(stderr, "%s, line %d: the group %s has no generators.\n", name,
+              nr, S.name.c_str());
+      exit(EXIT_FAILURE);
+    }
+
+    std::vector<Permutation> permutations;
+    for (const SignedPermutation &g : S.generators) {
+      permutations.push_back(g.p);
+      S.reorients |= g.reoriented != 0;
+    }
+    if (S.reorients == 0) {
+      S.G = makegroup(permutations);
+      S.order = S.G.order;
+    } else { // the signed permutations are listed
+      const size_t limit = 1 << 16;
+      S.action = makegroupaction(S.generators, limit);
+      if (S.action.elements.size() > limit) {
+        fprintf(stderr, "%s, line %d: the group %s has more than %zu "
+                        "elements.\n",
+                name, nr, S.name.c_str(), limit);
+        exit(EXIT_FAILURE);
+      }
+      S.order = static_cast<long long>(S.action.elements.size());
+    }
+    groups.push_back(std::move(S));
+  }
+
+  fclose(f);
+  return groups;
+}
+
+// finds the fixed points of all groups of the file: the groups are taken by
+// their order, so every subgroup H of a group G comes before it. Fix(G) is
+// the part of Fix(H) that is fixed by the generators of G that are not in H,
+// for the largest such H, so only the groups without a subgroup in the file
+// are searched. The actions of the permutations on the bases are made once
+// for all groups.
+static void sweep(const char *name, int length, int sat,
+                  unsigned int nr_threads) {
+  std::vector<SweepGroup> groups = readsweep(name);
+  ActionCache cache;
+  std::vector<size_t> order(groups.size());
+  for (size_t g = 0; g < groups.size(); g++)
+    order[g] = g;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return groups[a].order < groups[b].order;
+  });
+
+  for (size_t g : order) {
+    SweepGroup &S = groups[g];
+
+    // the largest subgroup that is done
+    SweepGroup *H = NULL;
+    for (SweepGroup &T : groups) {
+      if (!T.done || (H != NULL && T.order <= H->order))
+        continue;
+      int contained = 1;
+      for (const SignedPermutation &g : T.generators)
+        if (contains(S, g) == 0)
+          contained = 0;
+      if (contained)
+        H = &T;
+    }
+
+    if (H == NULL && S.order > 63) {
+      fprintf(stderr,
+              "The group %s has %lld elements and no subgroup in %s, at most "
+              "63 are possible.\n",
+              S.name.c_str(), S.order, name);
+      exit(EXIT_FAILURE);
+    }
+
+    FILE *out = openoutput(S.name.c_str(), S.order, S.args, NULL);
+    if (H == NULL) {
+      Context C = makecontext(S.generators, length, nr_threads, cache);
+      findfixed(C, out, NULL, NULL, NULL, 0, sat, nr_threads, &S.fixed);
+    } else {
+      statbegin("filter");
+      std::vector<SignedPermutation> generators = S.action.generators;
+      if (S.reorients == 0)
+        for (const Permutation &p : minimalgenerators(S.G))
+          generators.push_back({0, p});
+      std::vector<const BasisAction *> actions;
+      for (const SignedPermutation &g : generators)
+        if (contains(*H, g) == 0)
+          actions.push_back(&basisaction(cache, g));
+      for (const OM &M : H->fixed) {
+        int good = 1;
+        for (size_t k = 0; k < actions.size() && good; k++)
+          good = isfixedby(M, *actions[k]);
+        if (good) {
+          writeOM(M, out);
+          S.fixed.push_back(M);
+        }
+      }
+      statend(H->fixed.size());
+      printf("the group %s has %lld elements and the subgroup %s, %zu of its "
+             "%zu fixed points are left\n",
+             S.name.c_str(), S.order, H->name.c_str(), S.fixed.size(),
+             H->fixed.size());
+    }
+    fclose(out);
+    S.done = 1;
+
+    printf("%zu fixed points for MacP(%d,%d) under the action of the group "
+           "%s\n",
+           S.fixed.size(), R, N, S.name.c_str());
+  }
+
+  char text[300];
+  sprintf(text, "fixed_OMs_rank%d_%delements_sweep.json", R, N);
+  statreport(text);
+}
+
+// writes the text file of the group of the compact file name
+static void expand(const char *name) {
+  FILE *in = openfile(name, "rb");
+  CompactTable T;
+  if (readcompactheader(T, in) == 0) {
+    fprintf(stderr, "Could not read the file %s.\n", name);
+    exit(EXIT_FAILURE);
+  }
+
+  FILE *out = openoutput(T.name.c_str(), T.order, T.args, NULL);
+  OM M;
+  long long count = 0;
+  while (readcompactOM(T, M, in)) {
+    writeOM(M, out);
+    count++;
+  }
+  fclose(in);
+  fclose(out);
+
+  printf("%lld fixed points for MacP(%d,%d) under the action of the group %s\n",
+         count, R, N, T.name.c_str());
+}
+
+// writes the oriented matroids of the text file name to out as records of T,
+// returns their number
+static long long compress(const char *name, const CompactTable &T, FILE *out) {
+  FILE *in = openfile(name, "r");
+  OM M;
+  long long count = 0;
+  while (readOM(&M, in)) {
+    if (writecompactOM(T, M, out) == 0) {
+      fprintf(stderr,
+              "The oriented matroid number %lld of %s is not fixed under the "
+              "group.\n",
+              count + 1, name);
+      exit(EXIT_FAILURE);
+    }
+    count++;
+  }
+  fclose(in);
+  return count;
+}
+
+int main(int argc, char *argv[]) {
+  const char *name = NULL, *sweepfile = NULL;
+  const char *compressfile = NULL, *expandfile = NULL;
+  int dumplists = 0;
+  int sat = 0;
+  int compact = 0;
+  int length = 0; // the length of the prefixes, 0 if it is chosen
+  unsigned int nr_threads = std::thread::hardware_concurrency();
+  int i = 1;
+
+  while (i < argc && argv[i][0] == '-') {
+    if (strcmp(argv[i], "--dump") == 0)
+      dumplists = 1;
+    else if (strcmp(argv[i], "--sat") == 0)
+      sat = 1;
+    else if (strcmp(argv[i], "--sweep") == 0 && i + 1 < argc)
+      sweepfile = argv[++i];
+    else if (strcmp(argv[i], "--compact") == 0)
+      compact = 1;
+    else if (strcmp(argv[i], "--compress") == 0 && i + 1 < argc)
+      compressfile = argv[++i];
+    else if (strcmp(argv[i], "--expand") == 0 && i + 1 < argc)
+      expandfile = argv[++i];
+    else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+      name = argv[++i];
+    else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+      length = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+      nr_threads = static_cast<unsigned int>(atoi(argv[++i]));
+    else
+      break;
+    i++;
+  }
+
+  std::vector<SignedPermutation> generators;
+  int first = i; // the first generator
+  for (; i < argc; i++)
+    if (readgroup(argv[i], generators) == 0)
+      break;
+
+  if (nr_threads == 0)
+    nr_threads = 1;
+
+  int wrong = i < argc || length < 0;
+  if (expandfile != NULL) // the group is in the file
+    wrong = wrong || argc != 3;
+  else if (sweepfile == NULL)
+    wrong = wrong || generators.empty() || (dumplists && sat) ||
+            (compressfile != NULL && (dumplists || sat || compact));
+  else // the groups are in the file, one output file for each
+    wrong = wrong || !generators.empty() || dumplists || name != NULL ||
+            compact || compressfile != NULL;
+  if (wrong) {
+    printf("Usage: %s [--dump | --sat] [--compact] [-n group name] "
+           "[-j threads] [-l prefix length] generators...\n"
+           "       %s [--sat] [-j threads] [-l prefix length] --sweep file\n"
+           "       %s [-n group name] --compress file generators...\n"
+           "       %s --expand file\n"
+           "The generators are permutations in cycle notation, e.g. "
+           "\"(1,2,3)(4,5,6)\", followed by -e for every element e that "
+           "is reoriented, e.g. \"(1,2)(3,4)-5\", groups Zn, Dn, Sn or An "
+           "on the elements 1, ..., n, joined by + on the next elements, "
+           "e.g. Z3+Z3, Aut(chirotope), the symmetries of a chirotope, or "
+           "AutR(chirotope), its symmetries with reorientations.\n"
+           "With --sweep every line of the file is the name of a group and "
+           "its generators; the fixed points of a group are found from "
+           "those of its largest subgroup in the file.\n"
+           "With --compact the fixed points are written to a compact .fom "
+           "file, --compress makes it from the .txt file of the group, and "
+           "--expand makes the .txt file from it.\n",
+           argv[0], argv[0], argv[0], argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  if (sweepfile != NULL) {
+    sweep(sweepfile, length, sat, nr_threads);
+    return 0;
+  }
+  if (expandfile != NULL) {
+    expand(expandfile);
+    return 0;
+  }
+
+  ActionCache cache;
+  Context C = makecontext(generators, compressfile != NULL ? 1 : length,
+                          nr_threads, cache);
+
+  char text[300];
+  char group[100];
+  if (name != NULL)
+    snprintf(group, sizeof(group), "%s", name);
+  else if (argc - first == 1 && argv[first][0] != '(' &&
+           strncmp(argv[first], "Aut", 3) != 0) // a named group
+    snprintf(group, sizeof(group), "%s", argv[first]);
+  else
+    snprintf(group, sizeof(group), "order%d", C.sizeofgroup);
+
+  std::vector<std::string> args(argv + first, argv + argc);
+  CompactTable table = maketable(C, group, args);
+  FILE *out = openoutput(group, C.sizeofgroup, args,
+                         compact || compressfile != NULL ? &table : NULL);
+
+  if (compressfile != NULL) {
+    long long count = compress(compressfile, table, out);
+    fclose(out);
+    printf("%lld fixed points for MacP(%d,%d) under the action of the group "
+           "%s\n",
+           count, R, N, group);
+    return 0;
+  }
+
+  FILE *dump_prefixes = NULL, *dump_full = NULL;
+  if (dumplists) {
+    sprintf(text, "q-possible_chirotopes_tests%d_%d_Z%d_length%d.txt", R, N,
+            C.sizeofgroup, C.size);
+    dump_prefixes = openfile(text, "w");
+    sprintf(text, "q-possible_chirotopes_tests%d_%d_Z%d_length%d.txt", R, N,
+            C.sizeofgroup, C.orbitnr);
+    dump_full = C.size == C.orbitnr ? NULL : openfile(text, "w");
+  }
+
+  long long count = findfixed(C, out, compact ? &table : NULL, dump_prefixes,
+                              dump_full, dumplists, sat, nr_threads, NULL);
+
+  fclose(out);
+  if (dump_prefixes != NULL)
+    fclose(dump_prefixes);
+  if (dump_full != NULL)
+    fclose(dump_full);
+
+  printf("%lld fixed points for MacP(%d,%d) under the action of the group %s\n",
+         count, R, N, group);
+
+  sprintf(text, "fixed_OMs_rank%d_%delements_group_%s.json", R, N, group);
+  statreport(text);
+
+  return 0;
+}
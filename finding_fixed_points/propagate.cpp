@@ -0,0 +1,473 @@
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "propagate.h"
+
+void makepairs(const std::vector<std::vector<int>> &orbits,
+               const std::vector<int> &orind, std::vector<Pair> &pairs,
+               std::vector<std::vector<int>> &checks) {
+  std::array<unsigned char, R> x, y;
+  int orbitnr = static_cast<int>(orbits.size());
+  checks.assign(orbits.size(), {});
+  pairs.clear();
+
+  // the place of every basis in the orbits, the first one counts
+  std::vector<int> order(B);
+  for (int o = orbitnr - 1, n = 0; o >= 0; o--)
+    for (size_t k = orbits[static_cast<size_t>(o)].size(); k-- > 0;)
+      order[static_cast<size_t>(orbits[static_cast<size_t>(o)][k])] = n--;
+
+  for (int b1 = 0; b1 < B; b1++)
+    for (int b2 = 0; b2 < b1; b2++) {
+      int in1 = b1, in2 = b2;
+      if (order[static_cast<size_t>(in1)] < order[static_cast<size_t>(in2)])
+        std::swap(in1, in2);
+
+      Pair P{};
+      P.o1 = orind[static_cast<size_t>(in1)];
+      P.o2 = orind[static_cast<size_t>(in2)];
+      int first = std::max(P.o1, P.o2); // from here on the pair is checked
+      std::vector<int> levels = {first};
+
+      for (size_t j = 0; j < R;
+           j++) // different permutations of the first basis
+      {
+        for (size_t i = 0; i < R; i++) // axiom B2'
+        {
+          for (size_t k = 0; k < R; k++) {
+            x[k] = bases[static_cast<size_t>(in1), k];
+            y[k] = bases[static_cast<size_t>(in2), k];
+          }
+          std::swap(x[0], x[j]);
+          std::swap(x[0], y[i]);
+
+          auto [xs, s1] = sort(x);
+          auto [ys, s2] = sort(y);
+
+          if (s1 && s2) // both are bases, so they could be the i from B2'
+          {
+            int t1 = orind[static_cast<size_t>(ind(xs))];
+            int t2 = orind[static_cast<size_t>(ind(ys))];
+            P.witnesses.push_back({t1, t2});
+            levels.push_back(std::max(first, std::max(t1, t2)));
+          }
+        }
+        P.end[j] = static_cast<int>(P.witnesses.size());
+      }
+
+      std::sort(levels.begin(), levels.end());
+      levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+      for (int level : levels)
+        checks[static_cast<size_t>(level)].push_back(
+            static_cast<int>(pairs.size()));
+      pairs.push_back(std::move(P));
+    }
+}
+
+int isgood(const Pair &P, const signed char *l, int z) {
+  int begin = 0;
+
+  for (size_t j = 0; j < R; j++) // different permutations of the first basis
+  {
+    int found = 0;
+    for (int w = begin; w < P.end[j] && !found; w++) {
+      int t1 = P.witnesses[static_cast<size_t>(w)][0];
+      int t2 = P.witnesses[static_cast<size_t>(w)][1];
+
+      // one of them is not known yet, or both are nonzero
+      found = t1 >= z || t2 >= z || (l[t1] && l[t2]);
+    }
+
+    if (!found) // Axiom B2' is not fullfilled
+      return 0;
+    begin = P.end[j];
+  }
+
+  return 1;
+}
+
+Constraints makeconstraints(const std::vector<Pair> &pairs,
+                            const std::vector<int> &orind, int orbitnr) {
+  Constraints C;
+  C.nr = static_cast<size_t>(orbitnr);
+  C.orind = orind;
+  C.relations = makerelations();
+  C.watches.assign(C.nr, {});
+
+  // the exchanges as (o1, o2, witnesses...), with o1 <= o2 and t1 <= t2;
+  // a witness that consists of o1 and o2 is always there, so such
+  // exchanges are left out
+  std::map<std::vector<int>, int> known;
+  auto add = [&](int o1, int o2, std::vector<std::array<int, 2>> w) {
+    if (o1 > o2)
+      std::swap(o1, o2);
+    for (auto &t : w) {
+      if (t[0] > t[1])
+        std::swap(t[0], t[1]);
+      if ((t[0] == o1 || t[0] == o2) && (t[1] == o1 || t[1] == o2))
+        return;
+    }
+    std::sort(w.begin(), w.end());
+    w.erase(std::unique(w.begin(), w.end()), w.end());
+
+    std::vector<int> key = {o1, o2};
+    for (const auto &t : w)
+      key.insert(key.end(), t.begin(), t.end());
+    if (!known.emplace(key, static_cast<int>(C.exchanges.size())).second)
+      return;
+
+    Exchange E = {o1, o2, static_cast<int>(C.witnesses.size()), 0};
+    C.witnesses.insert(C.witnesses.end(), w.begin(), w.end());
+    E.end = static_cast<int>(C.witnesses.size());
+
+    std::vector<int> contained = {o1, o2};
+    for (const auto &t : w)
+      contained.insert(contained.end(), t.begin(), t.end());
+    std::sort(contained.begin(), contained.end());
+    contained.erase(std::unique(contained.begin(), contained.end()),
+                    contained.end());
+    for (int o : contained)
+      C.watches[static_cast<size_t>(o)].push_back(
+          static_cast<int>(C.exchanges.size()));
+    C.exchanges.push_back(E);
+  };
+
+  for (const Pair &P : pairs) {
+    int begin = 0;
+    for (size_t j = 0; j < R; j++) {
+      add(P.o1, P.o2,
+          std::vector<std::array<int, 2>>(P.witnesses.begin() + begin,
+                                          P.witnesses.begin() + P.end[j]));
+      begin = P.end[j];
+    }
+  }
+
+  // if one product of a relation is nonzero, another one is
+  for (const Relation &rel : C.relations)
+    for (int t = 0; t < 3; t++) {
+      std::vector<std::array<int, 2>> w;
+      for (int u = 0; u < 3; u++)
+        if (u != t)
+          w.push_back({orind[static_cast<size_t>(rel.bases[u][0])],
+                       orind[static_cast<size_t>(rel.bases[u][1])]});
+      add(orind[static_cast<size_t>(rel.bases[t][0])],
+          orind[static_cast<size_t>(rel.bases[t][1])], w);
+    }
+
+  return C;
+}
+
+void startlists(const Constraints &C, ListState &S) {
+  S.C = &C;
+  S.value.assign(C.nr, -1);
+  S.trail.clear();
+  S.head = 0;
+}
+
+static int putlist(ListState &S, int o, int v) {
+  signed char &x = S.value[static_cast<size_t>(o)];
+  if (x >= 0)
+    return x == v;
+  x = static_cast<signed char>(v);
+  S.trail.push_back(o);
+  return 1;
+}
+
+// the deductions from one exchange, returns 0 if it is violated
+static int checkexchange(ListState &S, const Exchange &E) {
+  int a = S.value[static_cast<size_t>(E.o1)];
+  int b = S.value[static_cast<size_t>(E.o2)];
+  if (a == 0 || b == 0)
+    return 1;
+
+  int alive = 0, last = 0; // the witnesses that can still be nonzero
+  for (int w = E.begin; w < E.end && alive < 2; w++) {
+    const auto &t = S.C->witnesses[static_cast<size_t>(w)];
+    if (S.value[static_cast<size_t>(t[0])] != 0 &&
+        S.value[static_cast<size_t>(t[1])] != 0) {
+      alive++;
+      last = w;
+    }
+  }
+
+  if (alive == 0) { // o1 and o2 are not both nonzero
+    if (E.o1 == E.o2 || a == 1)
+      return putlist(S, E.o2, 0);
+    if (b == 1)
+      return putlist(S, E.o1, 0);
+    return 1;
+  }
+
+  if (alive == 1 && a == 1 && b == 1) { // the last witness has to be it
+    const auto &t = S.C->witnesses[static_cast<size_t>(last)];
+    return putlist(S, t[0], 1) && putlist(S, t[1], 1);
+  }
+
+  return 1;
+}
+
+int setorbit(ListState &S, int o, int v) {
+  if (putlist(S, o, v) == 0)
+    return 0;
+
+  while (S.head < S.trail.size()) {
+    int p = S.trail[S.head++];
+    for (int e : S.C->watches[static_cast<size_t>(p)])
+      if (checkexchange(S, S.C->exchanges[static_cast<size_t>(e)]) == 0)
+        return 0;
+  }
+
+  return 1;
+}
+
+void undo(ListState &S, size_t mark) {
+  while (S.trail.size() > mark) {
+    S.value[static_cast<size_t>(S.trail.back())] = -1;
+    S.trail.pop_back();
+  }
+  S.head = std::min(S.head, mark);
+}
+
+// the orbit that is not known yet and is in the most exchanges that are not
+// decided by a zero orbit, -1 if all orbits are known
+static int chooseorbit(const ListState &S) {
+  int best = -1, most = -1;
+
+  for (int o = 0; o < static_cast<int>(S.C->nr); o++) {
+    if (S.value[static_cast<size_t>(o)] >= 0)
+      continue;
+    int n = 0;
+    for (int e : S.C->watches[static_cast<size_t>(o)]) {
+      const Exchange &E = S.C->exchanges[static_cast<size_t>(e)];
+      n += S.value[static_cast<size_t>(E.o1)] != 0 &&
+           S.value[static_cast<size_t>(E.o2)] != 0;
+    }
+    if (n > most) {
+      best = o;
+      most = n;
+    }
+  }
+
+  return best;
+}
+
+static void complete(ListState &S,
+                     std::vector<std::vector<signed char>> &lists) {
+  int o = chooseorbit(S);
+  if (o < 0) {
+    lists.push_back(S.value);
+    return;
+  }
+
+  for (int v = 0; v <= 1; v++) {
+    size_t mark = S.trail.size();
+    if (setorbit(S, o, v))
+      complete(S, lists);
+    undo(S, mark);
+  }
+}
+
+void completelists(ListState &S, std::vector<std::vector<signed char>> &lists) {
+  size_t first = lists.size();
+  complete(S, lists);
+  std::sort(lists.begin() + static_cast<long>(first), lists.end());
+}
+
+// a nonzero product of a relation for a full list: c * s[a] * s[b], with
+// a = b = -1 if it does not depend on the signs of the orbits
+struct Term {
+  int a, b;
+  int c;
+};
+
+// the nonzero products of a relation, there are two or three
+struct Active {
+  int n;
+  Term t[3];
+};
+
+struct SignState {
+  std::vector<Active> active;
+  std::vector<std::vector<int>> watches; // the relations that contain orbit i
+  std::vector<signed char> s;            // 0 if the sign is not known yet
+  std::vector<int> trail;
+  size_t head = 0;
+};
+
+static int value(const SignState &S, const Term &T) {
+  if (T.a < 0)
+    return T.c;
+  return T.c * S.s[static_cast<size_t>(T.a)] * S.s[static_cast<size_t>(T.b)];
+}
+
+static int unknowns(const SignState &S, const Term &T) {
+  if (T.a < 0)
+    return 0;
+  return (S.s[static_cast<size_t>(T.a)] == 0) +
+         (S.s[static_cast<size_t>(T.b)] == 0);
+}
+
+static int putsign(SignState &S, int o, int v) {
+  signed char &x = S.s[static_cast<size_t>(o)];
+  if (x != 0)
+    return x == v;
+  x = static_cast<signed char>(v);
+  S.trail.push_back(o);
+  return 1;
+}
+
+// makes the product T with one unknown sign equal to v
+static int force(SignState &S, const Term &T, int v) {
+  int o = S.s[static_cast<size_t>(T.a)] == 0 ? T.a : T.b;
+  int other = o == T.a ? T.b : T.a;
+  return putsign(S, o, v * T.c * S.s[static_cast<size_t>(other)]);
+}
+
+// the deductions from one relation, returns 0 if it is violated: the
+// products must not all be equal
+static int checkrelation(SignState &S, const Active &A) {
+  int v[3];
+  for (int i = 0; i < A.n; i++)
+    v[i] = value(S, A.t[i]);
+
+  if (A.n == 2) {
+    if (v[0] && v[1])
+      return v[0] != v[1];
+    for (int i = 0; i < 2; i++)
+      if (v[i] && unknowns(S, A.t[1 - i]) == 1)
+        return force(S, A.t[1 - i], -v[i]);
+    return 1;
+  }
+
+  for (int i = 0; i < 3; i++) {
+    int j = (i + 1) % 3, k = (i + 2) % 3;
+    if (v[j] == 0 || v[j] != v[k])
+      continue;
+    if (v[i])
+      return v[i] != v[j];
+    if (unknowns(S, A.t[i]) == 1)
+      return force(S, A.t[i], -v[j]);
+  }
+  return 1;
+}
+
+static int propagatesigns(SignState &S) {
+  while (S.head < S.trail.size()) {
+    int o = S.trail[S.head++];
+    for (int r : S.watches[static_cast<size_t>(o)])
+      if (checkrelation(S, S.active[static_cast<size_t>(r)]) == 0)
+        return 0;
+  }
+  return 1;
+}
+
+static void undosigns(SignState &S, size_t mark) {
+  while (S.trail.size() > mark) {
+    S.s[static_cast<size_t>(S.trail.back())] = 0;
+    S.trail.pop_back();
+  }
+  S.head = std::min(S.head, mark);
+}
+
+// the nonzero orbit that is not known yet and is in the most relations with
+// a known orbit, -1 if all are known
+static int choosesign(const SignState &S, const signed char *l) {
+  int best = -1, most = -1;
+
+  for (size_t o = 0; o < S.s.size(); o++) {
+    if (l[o] == 0 || S.s[o] != 0)
+      continue;
+    int n = 0;
+    for (int r : S.watches[o]) {
+      const Active &A = S.active[static_cast<size_t>(r)];
+      for (int i = 0; i < A.n; i++)
+        if (A.t[i].a >= 0 && (S.s[static_cast<size_t>(A.t[i].a)] != 0 ||
+                              S.s[static_cast<size_t>(A.t[i].b)] != 0)) {
+          n++;
+          break;
+        }
+    }
+    if (n > most) {
+      best = static_cast<int>(o);
+      most = n;
+    }
+  }
+
+  return best;
+}
+
+static void completesigns(SignState &S, const signed char *l,
+                          std::vector<std::vector<signed char>> &signs) {
+  int o = choosesign(S, l);
+  if (o < 0) {
+    signs.push_back(S.s);
+    return;
+  }
+
+  for (int v = 1; v >= -1; v -= 2) {
+    size_t mark = S.trail.size();
+    if (putsign(S, o, v) && propagatesigns(S))
+      completesigns(S, l, signs);
+    undosigns(S, mark);
+  }
+}
+
+void signvectors(const Constraints &C, const signed char *l,
+                 const signed char *w,
+                 std::vector<std::vector<signed char>> &signs) {
+  SignState S;
+  S.s.assign(C.nr, 0);
+  S.watches.assign(C.nr, {});
+
+  int last = -1;
+  for (int o = 0; o < static_cast<int>(C.nr); o++)
+    if (l[o])
+      last = o;
+  if (last < 0)
+    return;
+
+  for (const Relation &rel : C.relations) {
+    Active A;
+    A.n = 0;
+    for (int t = 0; t < 3; t++) {
+      int b0 = rel.bases[t][0], b1 = rel.bases[t][1];
+      int a = C.orind[static_cast<size_t>(b0)];
+      int b = C.orind[static_cast<size_t>(b1)];
+      if (l[a] == 0 || l[b] == 0)
+        continue;
+      Term T = {a, b, rel.sign[t] * w[b0] * w[b1]};
+      if (a == b) // the product does not depend on the sign of the orbit
+        T.a = T.b = -1;
+      A.t[A.n++] = T;
+    }
+
+    if (A.n == 1) // the list is not possible
+      return;
+    if (A.n == 0)
+      continue;
+
+    int r = static_cast<int>(S.active.size());
+    S.active.push_back(A);
+    std::vector<int> contained;
+    for (int i = 0; i < A.n; i++)
+      if (A.t[i].a >= 0) {
+        contained.push_back(A.t[i].a);
+        contained.push_back(A.t[i].b);
+      }
+    std::sort(contained.begin(), contained.end());
+    contained.erase(std::unique(contained.begin(), contained.end()),
+                    contained.end());
+    for (int o : contained)
+      S.watches[static_cast<size_t>(o)].push_back(r);
+  }
+
+  // the relations that are already decided, then the last orbit is positive
+  for (const Active &A : S.active)
+    if (checkrelation(S, A) == 0)
+      return;
+  if (putsign(S, last, 1) == 0 || propagatesigns(S) == 0)
+    return;
+
+  completesigns(S, l, signs);
+}
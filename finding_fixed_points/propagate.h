@@ -0,0 +1,101 @@
+#ifndef PROPAGATE_H
+#define PROPAGATE_H
+
+#include <array>
+#include <stddef.h>
+#include <vector>
+
+#include "OMs.h"
+
+// Constraint propagation for the search of fixed oriented matroids in
+// fixed_points.cpp. There the bases are split into the orbits of a group:
+// orbits[i][k] is the image of the first basis of the i-th orbit under the
+// k-th element of the group, and orind[b] is the orbit of the basis b. A list
+// l says which orbits are nonzero; given the list, the signs of the nonzero
+// orbits and a twist (see construct()), the signs of all bases are known.
+//
+// The constraints come from two properties of every chirotope:
+// - Axiom B2' for every pair of bases and every element of the first basis
+//   (see isgood() in short_l.c): if both bases are nonzero, then one of the
+//   pairs of bases made by exchanging that element is nonzero as well.
+// - The three-term Grassmann-Pluecker relations: the three products of
+//   two signs are all zero, or they contain both +1 and -1.
+// On the orbits these become constraints on the list (exchanges) and, once
+// the list is known, constraints on the signs of the orbits (relations).
+// Both searches assign one orbit at a time. After each assignment they
+// deduce what follows from the constraints that contain the orbit, and
+// then choose the most constrained orbit next. A trail of the assignments
+// makes undoing them cheap.
+
+// a pair of bases; the witnesses of the j-th element of the first basis are
+// witnesses[end[j-1]], ..., witnesses[end[j]-1]
+struct Pair {
+  std::vector<std::array<int, 2>> witnesses; // the orbits of the two bases
+  int o1, o2;                                // the orbits of the two bases
+  // one more if R is odd, so that the struct is not padded
+  int end[R + R % 2];
+};
+
+// if the orbits o1 and o2 are nonzero, then both orbits of one of the
+// witnesses[begin], ..., witnesses[end-1] are nonzero
+struct Exchange {
+  int o1, o2;
+  int begin, end;
+};
+
+// the constraints on the orbits, they are the same for every search
+struct Constraints {
+  size_t nr; // the number of orbits
+  std::vector<int> orind;
+  std::vector<Exchange> exchanges;
+  std::vector<std::array<int, 2>> witnesses;
+  std::vector<std::vector<int>> watches; // the exchanges that contain orbit i
+  std::vector<Relation> relations;
+};
+
+// the state of a search over the lists
+struct ListState {
+  const Constraints *C;
+  std::vector<signed char> value; // -1 if the orbit is not known yet
+  std::vector<int> trail;         // the orbits in the order they were set
+  size_t head;                    // the deductions of trail[0..head) are done
+};
+
+// makes the pairs of bases that short_l.c checks, with the first basis of a
+// pair being the later one in the orbits; checks[i] are the pairs that depend
+// on the orbit i, i.e. i is the later orbit of the two bases or a later orbit
+// of a witness
+void makepairs(const std::vector<std::vector<int>> &orbits,
+               const std::vector<int> &orind, std::vector<Pair> &pairs,
+               std::vector<std::vector<int>> &checks);
+
+// checks whether the two bases of P can be as they are given by l, the
+// orbits from z on are not known yet
+int isgood(const Pair &P, const signed char *l, int z);
+
+// makes the exchanges of the pairs (equal ones are stored once) and of the
+// Grassmann-Pluecker relations, and the relations
+Constraints makeconstraints(const std::vector<Pair> &pairs,
+                            const std::vector<int> &orind, int orbitnr);
+
+// a search in which no orbit is known
+void startlists(const Constraints &C, ListState &S);
+
+// sets orbit o to v (0 or 1) and deduces what follows, returns 0 if this
+// contradicts the constraints; undo(S, mark) with the length of the trail
+// before the call takes it back in either case
+int setorbit(ListState &S, int o, int v);
+
+void undo(ListState &S, size_t mark);
+
+// all full lists that extend the state, in lexicographical order
+void completelists(ListState &S, std::vector<std::vector<signed char>> &lists);
+
+// all signs of the nonzero orbits of the full list l that satisfy the
+// relations, the last nonzero orbit is positive; w[b] is the sign of the
+// basis b if its orbit is positive, for the bases of the nonzero orbits
+void signvectors(const Constraints &C, const signed char *l,
+                 const signed char *w,
+                 std::vector<std::vector<signed char>> &signs);
+
+#endif // PROPAGATE_H
@@ -0,0 +1,49 @@
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// A bounded queue between two stages of a pipeline: push() waits while the
+// queue is full, pop() waits while it is empty and returns false once the
+// queue is closed and empty.
+template <class T> class Queue {
+public:
+  explicit Queue(size_t capacity) : capacity(capacity) {}
+
+  void push(T x) {
+    std::unique_lock<std::mutex> lock(m);
+    not_full.wait(lock, [&] { return items.size() < capacity; });
+    items.push_back(std::move(x));
+    not_empty.notify_one();
+  }
+
+  bool pop(T &x) {
+    std::unique_lock<std::mutex> lock(m);
+    not_empty.wait(lock, [&] { return !items.empty() || closed; });
+    if (items.empty())
+      return false;
+    x = std::move(items.front());
+    items.pop_front();
+    not_full.notify_one();
+    return true;
+  }
+
+  // no more items will be pushed
+  void close() {
+    std::lock_guard<std::mutex> lock(m);
+    closed = true;
+    not_empty.notify_all();
+  }
+
+private:
+  std::mutex m;
+  std::condition_variable not_empty, not_full;
+  std::deque<T> items;
+  size_t capacity;
+  bool closed = false;
+  char reserved[7] = {}; // keeps the class free of padding
+};
+
+#endif // QUEUE_H
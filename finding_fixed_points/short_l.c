@@ -1,7 +1,10 @@
 #include </home/mi/palic/OMs.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 // This program makes a list of orbits of the action of the group on bases. It
 // makes only the first part, the rest is done by the program q-longer_l.c
@@ -451,12 +454,111 @@ int ispossible(
 
 long long int made;
 
+// Checkpoints: every CHECKPOINT_INTERVAL seconds (and on SIGTERM) the last
+// finished leaf of makepossible, the number of l's written so far and the size
+// of the output file are written to the checkpoint file. With --resume the
+// output is cut back to that size and the recursion continues after that leaf.
+#define CHECKPOINT_INTERVAL 600
+
+volatile sig_atomic_t stop_requested = 0;
+int resuming;   // 1 until makepossible reaches the leaf resume_l
+char *resume_l; // the last finished leaf of the previous run
+long long int resume_line; // the input line that was processed (longer_l.c)
+long long int current_line;
+time_t last_checkpoint;
+char checkpointname[300];
+
+void stophandler(int sig) { stop_requested = 1; }
+
+void writecheckpoint(char *l, int z, char *output) // written to a temporary
+                                                   // file and renamed, so the
+                                                   // checkpoint is never
+                                                   // incomplete
+{
+  FILE *tfile;
+  char text[300];
+  long offset;
+  int j, ok;
+
+  tfile = fopen(output, "a");
+  if (tfile == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", output);
+    exit(EXIT_FAILURE);
+  }
+  fseek(tfile, 0, SEEK_END);
+  offset = ftell(tfile);
+  fclose(tfile);
+
+  sprintf(text, "%s.tmp", checkpointname);
+  tfile = fopen(text, "w");
+  if (tfile == NULL) {
+    fprintf(stderr, "error fopen():  Could not open the file %s.\n", text);
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(tfile, "counter %lld\ncount %lld\noffset %ld\nprefix %d",
+          current_line, made, offset, z);
+  for (j = 0; j < z; j++)
+    fprintf(tfile, " %d", l[j]);
+  fputc('\n', tfile);
+
+  // the data has to be on the disk before the rename replaces the old
+  // checkpoint; the file is closed in any case
+  ok = fflush(tfile) == 0 && fsync(fileno(tfile)) == 0;
+  if (fclose(tfile) != 0)
+    ok = 0;
+  if (!ok || rename(text, checkpointname) != 0)
+    fprintf(stderr, "Could not write the checkpoint %s.\n", checkpointname);
+}
+
+int readcheckpoint(char *output, int z) // returns 0 if there is no checkpoint
+{
+  FILE *tfile;
+  long offset;
+  int j, x, len;
+
+  tfile = fopen(checkpointname, "r");
+  if (tfile == NULL)
+    return 0;
+
+  if (fscanf(tfile, "counter %lld count %lld offset %ld prefix %d",
+             &resume_line, &made, &offset, &len) != 4 ||
+      len != z) {
+    fclose(tfile);
+    resume_line = made = 0;
+    return 0;
+  }
+  for (j = 0; j < z; j++) {
+    if (fscanf(tfile, "%d", &x) != 1) { // a short or broken checkpoint
+      fclose(tfile);
+      resume_line = made = 0;
+      return 0;
+    }
+    resume_l[j] = x;
+  }
+  fclose(tfile);
+
+  if (truncate(output, offset) != 0) { // these l's are made again
+    fprintf(stderr, "Could not truncate the file %s.\n", output);
+    exit(EXIT_FAILURE);
+  }
+  resuming = 1;
+
+  return 1;
+}
+
 void makepossible(char *l, int i,
                   int z) // z is the length of l that we are making, in final
                          // version z=orbitnr make first z signs of tests that
                          // do not lead to a contradiction
 {
   if (i == z) {
+    if (resuming) // this is the leaf of the checkpoint, it is already done
+    {
+      resuming = 0;
+      return;
+    }
+
     if (ispossible(l, z)) {
       FILE *tfile;
       char text[300];
@@ -478,16 +580,33 @@ void makepossible(char *l, int i,
       made++;
     }
 
+    if (stop_requested ||
+        time(NULL) - last_checkpoint >= CHECKPOINT_INTERVAL) {
+      char text[300];
+      sprintf(text, "q-possible_chirotopes_tests%d_%d_Z%d_length%d.txt", R, N,
+              sizeofgroup, size);
+      writecheckpoint(l, z, text);
+      if (stop_requested) {
+        printf("Stopped, %lld l's so far. Continue with --resume.\n", made);
+        exit(EXIT_SUCCESS);
+      }
+      last_checkpoint = time(NULL);
+    }
+
     return;
   }
 
-  l[i] = 0;
-  makepossible(l, i + 1, z);
+  if (!resuming || resume_l[i] == 0) // when resuming, the branches before the
+                                     // checkpoint are skipped
+  {
+    l[i] = 0;
+    makepossible(l, i + 1, z);
+  }
   l[i] = 1;
   makepossible(l, i + 1, z);
 }
 
-main() {
+int main(int argc, char *argv[]) {
   R = 4;
   N = 8;
   initializeprogram();
@@ -511,17 +630,31 @@ main() {
   made = 0;
 
   char l[orbitnr];
+  char r[orbitnr];
+  resume_l = r;
 
   FILE *tfile;
   char text[300];
   sprintf(text, "q-possible_chirotopes_tests%d_%d_Z%d_length%d.txt", R, N,
           sizeofgroup, size);
-  tfile = fopen(text, "w");
-  if (tfile == NULL) {
-    fprintf(stderr, "error fopen():  Could not open the file %s.\n", text);
-    exit(EXIT_FAILURE);
+  sprintf(checkpointname,
+          "q-possible_chirotopes_tests%d_%d_Z%d_length%d.checkpoint", R, N,
+          sizeofgroup, size);
+
+  if (argc == 2 && strcmp(argv[1], "--resume") == 0 &&
+      readcheckpoint(text, size)) // continue after the last checkpoint
+    printf("Resuming with %lld l's.\n", made);
+  else {
+    tfile = fopen(text, "w");
+    if (tfile == NULL) {
+      fprintf(stderr, "error fopen():  Could not open the file %s.\n", text);
+      exit(EXIT_FAILURE);
+    }
+    fclose(tfile);
   }
-  fclose(tfile);
+
+  signal(SIGTERM, stophandler);
+  last_checkpoint = time(NULL);
 
   clock_t begin, end;
   begin = clock();
@@ -532,5 +665,6 @@ main() {
          ((double)(end - begin)) / CLOCKS_PER_SEC / 60, made, R, N, sizeofgroup,
          size);
 
+  remove(checkpointname); // the run is complete
   closeprogram();
 }